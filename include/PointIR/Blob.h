@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTIR_BLOB__INCLUDED_
+#define _POINTIR_BLOB__INCLUDED_
+
+
+#include "Point.h"
+
+
+/**
+ * The extents of a detected point - given in the same coordinate system as the point (image pixels before unprojection).
+ *
+ * Width and height are the sides of the smallest rectangle enclosing the blob, which is rotated by angle radians
+ * (in the range [0,pi)) - the width side points along the rotated x axis.
+ * The intensity is the value of the brightest pixel of the blob, scaled to the range [0,1].
+ */
+struct PointIR_Blob
+{
+	PointIR_Point_Component width;
+	PointIR_Point_Component height;
+	PointIR_Point_Component area;
+	PointIR_Point_Component angle;
+	PointIR_Point_Component intensity;
+
+#if __cplusplus
+	/// Initializes all components to their default value.
+	inline PointIR_Blob() : width(0), height(0), area(0), angle(0), intensity(0) {}
+
+	/// Initializes all components to the given values.
+	template<class U> inline PointIR_Blob( U _width, U _height, U _area, U _angle = 0, U _intensity = 0 ) :
+		width(_width), height(_height), area(_area), angle(_angle), intensity(_intensity) {}
+#endif
+};
+
+typedef struct PointIR_Blob PointIR_Blob;
+
+
+#if __cplusplus
+namespace PointIR
+{
+	typedef PointIR_Blob Blob;
+}
+#endif
+
+
+#endif
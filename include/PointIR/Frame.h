@@ -48,66 +48,156 @@ typedef struct
 #include <new>
 #include <type_traits>
 #include <cstddef>
+#include <iterator>
 #include <cstring>
+#include <utility>
+#include <cassert>
+
+#ifdef _WIN32
+	#include <malloc.h>
+#endif
 
 namespace PointIR
 {
+	/**
+	 * An 8 bit greyscale image. The pixels are stored in rows of stride bytes, the first row aligned to Frame::alignment bytes.
+	 * Rows are packed (stride equals width) unless a larger stride was requested.
+	 *
+	 * PointIR_Frame is only the wire format - see serialize() and deserialize().
+	 */
 	class Frame
 	{
 	public:
 		typedef decltype(PointIR_Frame::width) WidthType;
 		typedef decltype(PointIR_Frame::height) HeightType;
 
-		Frame()
+		/// Enough for the widest vector instructions - the storage is also padded to a multiple of this.
+		static const std::size_t alignment = 64;
+
+		Frame() noexcept {}
+
+		Frame( WidthType width, HeightType height, std::size_t stride = 0 )
 		{
-			frame = (PointIR_Frame*) calloc( 1, sizeof(PointIR_Frame) );
-			if( !frame )
-				throw std::bad_alloc();
+			this->resize( width, height, stride );
 		}
 
 		~Frame()
 		{
-			free( frame );
+			deallocate( this->pixels );
 		}
 
 		Frame( const Frame & other )
 		{
-			frame = (PointIR_Frame*) malloc( sizeInBytes( other.getWidth(), other.getHeight() ) );
-			if( !frame )
-				throw std::bad_alloc();
-			memcpy( frame, other.frame, sizeInBytes( other.getWidth(), other.getHeight() ) );
+			*this = other;
 		}
 
+		/// Copies the pixels and the stride.
 		Frame & operator=( const Frame & other )
 		{
-			this->resize( other.getWidth(), other.getHeight() );
-			memcpy( this->frame, other.frame, sizeInBytes( other.getWidth(), other.getHeight() ) );
+			if( this == &other )
+				return *this;
+			this->resize( other.width, other.height, other.stride );
+			if( this->isContiguous() )
+				memcpy( this->pixels, other.pixels, this->size() );
+			else
+			{
+				for( HeightType y = 0; y < this->height; y++ )
+					memcpy( this->getRow( y ), other.getRow( y ), this->width );
+			}
+			return *this;
+		}
+
+		/// Takes the pixels of the other frame, which is left empty.
+		Frame( Frame && other ) noexcept
+		{
+			this->swap( other );
+		}
+
+		/// Exchanges the pixels with the other frame - the other frame gets the previous pixels and storage of this one.
+		Frame & operator=( Frame && other ) noexcept
+		{
+			this->swap( other );
 			return *this;
 		}
 
-		WidthType       getWidth()  const noexcept { return frame->width; }
-		HeightType      getHeight() const noexcept { return frame->height; }
-		const uint8_t * getData()   const noexcept { return frame->data; }
-		uint8_t *       getData()         noexcept { return frame->data; }
+		void swap( Frame & other ) noexcept
+		{
+			std::swap( this->pixels, other.pixels );
+			std::swap( this->width, other.width );
+			std::swap( this->height, other.height );
+			std::swap( this->stride, other.stride );
+			std::swap( this->capacity, other.capacity );
+		}
+
+		WidthType       getWidth()  const noexcept { return this->width; }
+		HeightType      getHeight() const noexcept { return this->height; }
+		/// Distance between the starts of two rows in bytes.
+		std::size_t     getStride() const noexcept { return this->stride; }
+		/// Number of bytes that may be stored without allocating.
+		std::size_t     getCapacity() const noexcept { return this->capacity; }
+		bool            isContiguous() const noexcept { return this->stride == this->width; }
+
+		const uint8_t * getData()   const noexcept { return this->pixels; }
+		uint8_t *       getData()         noexcept { return this->pixels; }
+		const uint8_t * getRow( unsigned int y ) const noexcept { return this->pixels + y * this->stride; }
+		uint8_t *       getRow( unsigned int y )       noexcept { return this->pixels + y * this->stride; }
+
+		const uint8_t & getAt( unsigned int x, unsigned int y ) const noexcept { return this->pixels[ x + y * this->stride ]; }
+		uint8_t &       getAt( unsigned int x, unsigned int y )       noexcept { return this->pixels[ x + y * this->stride ]; }
+
+		/// Packs the rows if a stride smaller than the width is given. The storage only grows, so resizing a frame that has been
+		/// this large before never allocates. The pixels are undefined after the size or stride changed.
+		void resize( WidthType newWidth, HeightType newHeight, std::size_t newStride = 0 )
+		{
+			if( newStride < newWidth )
+				newStride = newWidth;
+			std::size_t bytes = newStride * newHeight;
+			if( bytes > this->capacity )
+			{
+				uint8_t * newPixels = allocate( bytes );
+				deallocate( this->pixels );
+				this->pixels = newPixels;
+				this->capacity = ( bytes + alignment - 1 ) / alignment * alignment;
+			}
+			this->width = newWidth;
+			this->height = newHeight;
+			this->stride = newStride;
+		}
 
-		const uint8_t & getAt( unsigned int x, unsigned int y ) const noexcept { return frame->data[ x + y * frame->width ]; }
-		uint8_t &       getAt( unsigned int x, unsigned int y )       noexcept { return frame->data[ x + y * frame->width ]; }
+		/// The smallest stride for the width that keeps every row aligned.
+		static std::size_t alignedStride( WidthType width ) noexcept
+		{
+			return ( width + alignment - 1 ) / alignment * alignment;
+		}
 
-		explicit operator const PointIR_Frame*() const noexcept { return frame; }
-		explicit operator PointIR_Frame*() noexcept { return frame; }
+		/// Size of the frame as PointIR_Frame with packed rows.
+		std::size_t getSerializedSize() const noexcept { return sizeof(PointIR_Frame) + this->size(); }
 
-		void resize( WidthType newWidth, HeightType newHeight )
+		/// Writes the frame as PointIR_Frame - the buffer needs getSerializedSize() bytes.
+		void serialize( void * buffer ) const noexcept
 		{
-			if( (newWidth != frame->width) || (newHeight != frame->height) )
+			PointIR_Frame * packet = static_cast< PointIR_Frame * >( buffer );
+			packet->width = this->width;
+			packet->height = this->height;
+			if( this->isContiguous() )
+				memcpy( packet->data, this->pixels, this->size() );
+			else
 			{
-				frame = (PointIR_Frame*) realloc( frame, sizeInBytes( newWidth, newHeight ) );
-				if( !frame )
-					throw std::bad_alloc();
-				frame->width = newWidth;
-				frame->height = newHeight;
+				for( HeightType y = 0; y < this->height; y++ )
+					memcpy( packet->data + y * this->width, this->getRow( y ), this->width );
 			}
 		}
 
+		/// Reads a PointIR_Frame - false if the buffer is too small to hold it.
+		bool deserialize( const void * buffer, std::size_t bufferSize )
+		{
+			const PointIR_Frame * packet = static_cast< const PointIR_Frame * >( buffer );
+			if( bufferSize < sizeof(PointIR_Frame) || bufferSize - sizeof(PointIR_Frame) < (std::size_t)packet->width * packet->height )
+				return false;
+			this->resize( packet->width, packet->height );
+			memcpy( this->pixels, packet->data, this->size() );
+			return true;
+		}
 
 		////////////////////////////////////////////////////////////////
 		// STL compatibility
@@ -130,17 +220,31 @@ namespace PointIR
 			typedef typename Frame::pointer         pointer;
 			typedef typename Frame::size_type       size_type;
 			typedef typename Frame::difference_type difference_type;
-			//TODO: implement remaining operations (http://www.cplusplus.com/reference/iterator/RandomAccessIterator/)
-			//typedef std::random_access_iterator_tag iterator_category;
-
-			iterator( pointer initial )                           noexcept { current = initial; }
-			iterator( const iterator & other )                    noexcept { current = other.current; }
-			iterator & operator++()                               noexcept { ++current; return *this; }
-			iterator & operator= ( const iterator & other )       noexcept { current = other.current; return *this; }
-			bool       operator==( const iterator & other ) const noexcept { return current == other.current; }
-			bool       operator!=( const iterator & other ) const noexcept { return current != other.current; }
-			reference  operator* ()                         const noexcept { return *current; }
-			pointer    operator->()                         const noexcept { return current; }
+			typedef std::random_access_iterator_tag iterator_category;
+
+			iterator()                                                  noexcept { current = nullptr; }
+			iterator( pointer initial )                                 noexcept { current = initial; }
+			iterator( const iterator & other )                          noexcept { current = other.current; }
+			iterator & operator= ( const iterator & other )             noexcept { current = other.current; return *this; }
+			iterator & operator++()                                     noexcept { ++current; return *this; }
+			iterator   operator++( int )                                noexcept { return iterator( current++ ); }
+			iterator & operator--()                                     noexcept { --current; return *this; }
+			iterator   operator--( int )                                noexcept { return iterator( current-- ); }
+			iterator & operator+=( difference_type n )                  noexcept { current += n; return *this; }
+			iterator & operator-=( difference_type n )                  noexcept { current -= n; return *this; }
+			iterator   operator+ ( difference_type n )            const noexcept { return iterator( current + n ); }
+			iterator   operator- ( difference_type n )            const noexcept { return iterator( current - n ); }
+			difference_type operator-( const iterator & other )   const noexcept { return current - other.current; }
+			bool       operator==( const iterator & other )       const noexcept { return current == other.current; }
+			bool       operator!=( const iterator & other )       const noexcept { return current != other.current; }
+			bool       operator< ( const iterator & other )       const noexcept { return current <  other.current; }
+			bool       operator> ( const iterator & other )       const noexcept { return current >  other.current; }
+			bool       operator<=( const iterator & other )       const noexcept { return current <= other.current; }
+			bool       operator>=( const iterator & other )       const noexcept { return current >= other.current; }
+			reference  operator* ()                               const noexcept { return *current; }
+			pointer    operator->()                               const noexcept { return current; }
+			reference  operator[]( difference_type n )            const noexcept { return current[n]; }
+			friend iterator operator+( difference_type n, const iterator & it ) noexcept { return it + n; }
 		private:
 			pointer current;
 		};
@@ -153,49 +257,95 @@ namespace PointIR
 			typedef typename Frame::const_pointer   const_pointer;
 			typedef typename Frame::size_type       size_type;
 			typedef typename Frame::difference_type difference_type;
-			//TODO: implement remaining operations (http://www.cplusplus.com/reference/iterator/RandomAccessIterator/)
-			//typedef std::random_access_iterator_tag iterator_category;
-
-			const_iterator( const_pointer initial )                           noexcept { current = initial; }
-			const_iterator( const iterator & other )                          noexcept { current = other.current; }
-			const_iterator( const const_iterator & other )                    noexcept { current = other.current; }
-			const_iterator & operator++()                                     noexcept { ++current; return *this; }
-			const_iterator & operator= ( const const_iterator & other )       noexcept { current = other.current; return *this; }
-			bool             operator==( const const_iterator & other ) const noexcept { return current == other.current; }
-			bool             operator!=( const const_iterator & other ) const noexcept { return current != other.current; }
-			const_reference  operator* ()                               const noexcept { return *current; }
-			const_pointer    operator->()                               const noexcept { return current; }
+			typedef const_reference                 reference;
+			typedef const_pointer                   pointer;
+			typedef std::random_access_iterator_tag iterator_category;
+
+			const_iterator()                                                        noexcept { current = nullptr; }
+			const_iterator( const_pointer initial )                                 noexcept { current = initial; }
+			const_iterator( const iterator & other )                                noexcept { current = other.current; }
+			const_iterator( const const_iterator & other )                          noexcept { current = other.current; }
+			const_iterator & operator= ( const const_iterator & other )             noexcept { current = other.current; return *this; }
+			const_iterator & operator++()                                           noexcept { ++current; return *this; }
+			const_iterator   operator++( int )                                      noexcept { return const_iterator( current++ ); }
+			const_iterator & operator--()                                           noexcept { --current; return *this; }
+			const_iterator   operator--( int )                                      noexcept { return const_iterator( current-- ); }
+			const_iterator & operator+=( difference_type n )                        noexcept { current += n; return *this; }
+			const_iterator & operator-=( difference_type n )                        noexcept { current -= n; return *this; }
+			const_iterator   operator+ ( difference_type n )                  const noexcept { return const_iterator( current + n ); }
+			const_iterator   operator- ( difference_type n )                  const noexcept { return const_iterator( current - n ); }
+			difference_type  operator- ( const const_iterator & other )       const noexcept { return current - other.current; }
+			bool             operator==( const const_iterator & other )       const noexcept { return current == other.current; }
+			bool             operator!=( const const_iterator & other )       const noexcept { return current != other.current; }
+			bool             operator< ( const const_iterator & other )       const noexcept { return current <  other.current; }
+			bool             operator> ( const const_iterator & other )       const noexcept { return current >  other.current; }
+			bool             operator<=( const const_iterator & other )       const noexcept { return current <= other.current; }
+			bool             operator>=( const const_iterator & other )       const noexcept { return current >= other.current; }
+			const_reference  operator* ()                                     const noexcept { return *current; }
+			const_pointer    operator->()                                     const noexcept { return current; }
+			const_reference  operator[]( difference_type n )                  const noexcept { return current[n]; }
+			friend const_iterator operator+( difference_type n, const const_iterator & it ) noexcept { return it + n; }
 		private:
 			const_pointer current;
 		};
 
-		bool      empty() const noexcept { return (frame->width == 0) || (frame->height == 0); }
-		size_type size()  const noexcept { return frame->width * frame->height; }
+		// the iterators and operator[] cover width * height bytes - which are only the pixels of contiguous frames,
+		// use getRow or getAt for others
+
+		bool      empty() const noexcept { return (this->width == 0) || (this->height == 0); }
+		size_type size()  const noexcept { return this->width * this->height; }
 
-		pointer       data()        noexcept { return frame->data; }
-		const_pointer data()  const noexcept { return frame->data; }
+		pointer       data()        noexcept { return this->pixels; }
+		const_pointer data()  const noexcept { return this->pixels; }
 
-		iterator       begin()        noexcept { return iterator( frame->data ); }
-		const_iterator begin()  const noexcept { return iterator( frame->data ); }
-		const_iterator cbegin() const noexcept { return iterator( frame->data ); }
-		iterator       end()          noexcept { return iterator( frame->data + size() ); }
-		const_iterator end()    const noexcept { return iterator( frame->data + size() ); }
-		const_iterator cend()   const noexcept { return iterator( frame->data + size() ); }
+		iterator       begin()        noexcept { assert( this->isContiguous() ); return iterator( this->pixels ); }
+		const_iterator begin()  const noexcept { assert( this->isContiguous() ); return iterator( this->pixels ); }
+		const_iterator cbegin() const noexcept { assert( this->isContiguous() ); return iterator( this->pixels ); }
+		iterator       end()          noexcept { assert( this->isContiguous() ); return iterator( this->pixels + size() ); }
+		const_iterator end()    const noexcept { assert( this->isContiguous() ); return iterator( this->pixels + size() ); }
+		const_iterator cend()   const noexcept { assert( this->isContiguous() ); return iterator( this->pixels + size() ); }
 
-		const_reference front() const noexcept { return frame->data[0]; }
-		reference       front()       noexcept { return frame->data[0]; }
-		const_reference back()  const noexcept { return frame->data[size()-1]; }
-		reference       back()        noexcept { return frame->data[size()-1]; }
+		const_reference front() const noexcept { return this->pixels[0]; }
+		reference       front()       noexcept { return this->pixels[0]; }
+		const_reference back()  const noexcept { assert( this->isContiguous() ); return this->pixels[size()-1]; }
+		reference       back()        noexcept { assert( this->isContiguous() ); return this->pixels[size()-1]; }
 
-		const_reference operator[]( size_type i ) const noexcept { return frame->data[i]; }
-		reference       operator[]( size_type i )       noexcept { return frame->data[i]; }
+		const_reference operator[]( size_type i ) const noexcept { assert( this->isContiguous() ); return this->pixels[i]; }
+		reference       operator[]( size_type i )       noexcept { assert( this->isContiguous() ); return this->pixels[i]; }
 
 		////////////////////////////////////////////////////////////////
 
 	private:
-		static size_t sizeInBytes( WidthType newWidth, HeightType newHeight ) { return sizeof(PointIR_Frame) + newWidth * newHeight; }
+		// padded to whole multiples of the alignment, so vector loads never cross the end of the storage
+		static uint8_t * allocate( std::size_t bytes )
+		{
+			bytes = ( bytes + alignment - 1 ) / alignment * alignment;
+#ifdef _WIN32
+			void * memory = _aligned_malloc( bytes, alignment );
+			if( !memory )
+				throw std::bad_alloc();
+#else
+			void * memory = nullptr;
+			if( posix_memalign( &memory, alignment, bytes ) )
+				throw std::bad_alloc();
+#endif
+			return static_cast< uint8_t * >( memory );
+		}
+
+		static void deallocate( uint8_t * memory ) noexcept
+		{
+#ifdef _WIN32
+			_aligned_free( memory );
+#else
+			free( memory );
+#endif
+		}
 
-		PointIR_Frame * frame = nullptr;
+		uint8_t * pixels = nullptr;
+		WidthType width = 0;
+		HeightType height = 0;
+		std::size_t stride = 0;
+		std::size_t capacity = 0;
 	};
 }
 
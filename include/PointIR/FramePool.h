@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTIR_FRAMEPOOL__INCLUDED_
+#define _POINTIR_FRAMEPOOL__INCLUDED_
+
+
+#include <PointIR/Frame.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace PointIR
+{
+	/**
+	 * Hands out frames that return to the pool when their handle is destroyed. Recycled frames keep their storage, so once
+	 * the pool is warmed up, passing frames of the same size between threads doesn't allocate.
+	 * May be used from any thread - handles must not outlive the pool.
+	 */
+	class FramePool
+	{
+	public:
+		class Recycler
+		{
+		public:
+			Recycler( FramePool * pool = nullptr ) noexcept : pool(pool) {}
+			void operator()( Frame * frame ) const
+			{
+				if( this->pool )
+					this->pool->recycle( frame );
+				else
+					delete frame;
+			}
+		private:
+			FramePool * pool;
+		};
+
+		typedef std::unique_ptr< Frame, Recycler > Handle;
+
+		FramePool( const FramePool & ) = delete; // disable copy constructor
+		FramePool & operator=( const FramePool & ) = delete; // disable assignment operator
+
+		/// Keeps at most maxFree unused frames - more are destroyed when released.
+		explicit FramePool( std::size_t maxFree = 4 ) : maxFree(maxFree)
+		{
+			this->free.reserve( maxFree );
+		}
+
+		~FramePool()
+		{
+			for( Frame * frame : this->free )
+				delete frame;
+		}
+
+		/// A frame of the given size - recycled if one is available. Its pixels are undefined.
+		Handle acquire( Frame::WidthType width, Frame::HeightType height, std::size_t stride = 0 )
+		{
+			Handle handle = this->acquire();
+			handle->resize( width, height, stride );
+			return handle;
+		}
+
+		/// A recycled frame of whatever size it had before - or a new empty one.
+		Handle acquire()
+		{
+			Frame * frame = nullptr;
+			{
+				std::lock_guard< std::mutex > lock( this->mutex );
+				if( !this->free.empty() )
+				{
+					frame = this->free.back();
+					this->free.pop_back();
+				}
+			}
+			if( !frame )
+				frame = new Frame;
+			return Handle( frame, Recycler( this ) );
+		}
+
+	private:
+		void recycle( Frame * frame )
+		{
+			{
+				std::lock_guard< std::mutex > lock( this->mutex );
+				if( this->free.size() < this->maxFree )
+				{
+					this->free.push_back( frame );
+					return;
+				}
+			}
+			delete frame;
+		}
+
+		std::mutex mutex;
+		std::vector< Frame * > free;
+		std::size_t maxFree;
+	};
+}
+
+
+#endif
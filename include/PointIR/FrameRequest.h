@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTIR_FRAMEREQUEST__INCLUDED_
+#define _POINTIR_FRAMEREQUEST__INCLUDED_
+
+
+#include <stdint.h>
+
+
+/*
+ * Sent by clients of the frame socket to tell the daemon which frames they need.
+ * The region is cropped first, then every n-th pixel of it is kept in both directions.
+ * Clients not sending a request receive every frame in full resolution.
+ */
+typedef struct
+{
+	uint32_t maxFPS;     /* 0 for every captured frame */
+	uint32_t decimation; /* 0 or 1 for full resolution */
+	uint32_t cropX;
+	uint32_t cropY;
+	uint32_t cropWidth;  /* 0 for the remaining width of the frame */
+	uint32_t cropHeight; /* 0 for the remaining height of the frame */
+} PointIR_FrameRequest;
+
+
+#endif
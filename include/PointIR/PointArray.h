@@ -47,7 +47,10 @@ typedef struct
 #include <stdlib.h>
 #include <new>
 #include <cstddef>
+#include <iterator>
 #include <cstring>
+#include <algorithm>
+#include <utility>
 
 namespace PointIR
 {
@@ -56,35 +59,57 @@ namespace PointIR
 	public:
 		typedef decltype(PointIR_PointArray::count) CountType;
 
-		PointArray()
+		/// Doesn't allocate until points are added.
+		PointArray() noexcept
 		{
-			pointArray = (PointIR_PointArray*) calloc( 1, sizeof(PointIR_PointArray) );
-			if( !pointArray )
-				throw std::bad_alloc();
-			pointArrayCapacity = 0;
 		}
 
 		~PointArray()
 		{
-			free( pointArray );
+			if( pointArray != emptyArray() )
+				free( pointArray );
 		}
 
 		PointArray( const PointArray & other )
 		{
-			pointArray = (PointIR_PointArray*) malloc( sizeInBytes( other.size() ) );
-			if( !pointArray )
-				throw std::bad_alloc();
-			pointArrayCapacity = other.size();
-			memcpy( pointArray, other.pointArray, sizeInBytes( other.size() ) );
+			*this = other;
+		}
+
+		/// Takes the points of the other array, which is left empty.
+		PointArray( PointArray && other ) noexcept
+		{
+			this->swap( other );
 		}
 
+		/// Only allocates if the other array has more points than fit into this one.
 		PointArray & operator=( const PointArray & other )
 		{
-			resize( other.size() );
-			memcpy( pointArray, other.pointArray, sizeInBytes( other.size() ) );
+			if( this == &other )
+				return *this;
+			resizeIfNeeded( other.size() );
+			memcpy( static_cast< void * >( pointArray->points ), other.pointArray->points, other.size() * sizeof(PointIR_Point) );
 			return *this;
 		}
 
+		/// Takes the points of the other array, which is left empty - the previous storage of this one is freed.
+		PointArray & operator=( PointArray && other ) noexcept
+		{
+			if( this == &other )
+				return *this;
+			this->swap( other );
+			if( other.pointArray != emptyArray() )
+				free( other.pointArray );
+			other.pointArray = emptyArray();
+			other.pointArrayCapacity = 0;
+			return *this;
+		}
+
+		void swap( PointArray & other ) noexcept
+		{
+			std::swap( pointArray, other.pointArray );
+			std::swap( pointArrayCapacity, other.pointArrayCapacity );
+		}
+
 		CountType     getCount()  const noexcept { return pointArray->count; }
 		const Point * getPoints() const noexcept { return pointArray->points; }
 		Point *       getPoints()       noexcept { return pointArray->points; }
@@ -92,11 +117,13 @@ namespace PointIR
 		explicit operator const PointIR_PointArray*() const noexcept { return pointArray; }
 		explicit operator PointIR_PointArray*() noexcept { return pointArray; }
 
+		/// Sets the number of points - the capacity grows geometrically and never shrinks, so repeatedly filling the array
+		/// with a similar number of points doesn't allocate.
 		void resizeIfNeeded( CountType newCount )
 		{
 			if( newCount > pointArrayCapacity )
-				_resize( newCount );
-			pointArray->count = newCount;
+				_resize( std::max( newCount, pointArrayCapacity * 2 ) );
+			setCount( newCount );
 		}
 
 
@@ -121,17 +148,31 @@ namespace PointIR
 			typedef typename PointArray::pointer         pointer;
 			typedef typename PointArray::size_type       size_type;
 			typedef typename PointArray::difference_type difference_type;
-			//TODO: implement remaining operations (http://www.cplusplus.com/reference/iterator/RandomAccessIterator/)
-			//typedef std::random_access_iterator_tag iterator_category;
-
-			iterator( pointer initial )                           noexcept { current = initial; }
-			iterator( const iterator & other )                    noexcept { current = other.current; }
-			iterator & operator++()                               noexcept { ++current; return *this; }
-			iterator & operator= ( const iterator & other )       noexcept { current = other.current; return *this; }
-			bool       operator==( const iterator & other ) const noexcept { return current == other.current; }
-			bool       operator!=( const iterator & other ) const noexcept { return current != other.current; }
-			reference  operator* ()                         const noexcept { return *current; }
-			pointer    operator->()                         const noexcept { return current; }
+			typedef std::random_access_iterator_tag iterator_category;
+
+			iterator()                                                  noexcept { current = nullptr; }
+			iterator( pointer initial )                                 noexcept { current = initial; }
+			iterator( const iterator & other )                          noexcept { current = other.current; }
+			iterator & operator= ( const iterator & other )             noexcept { current = other.current; return *this; }
+			iterator & operator++()                                     noexcept { ++current; return *this; }
+			iterator   operator++( int )                                noexcept { return iterator( current++ ); }
+			iterator & operator--()                                     noexcept { --current; return *this; }
+			iterator   operator--( int )                                noexcept { return iterator( current-- ); }
+			iterator & operator+=( difference_type n )                  noexcept { current += n; return *this; }
+			iterator & operator-=( difference_type n )                  noexcept { current -= n; return *this; }
+			iterator   operator+ ( difference_type n )            const noexcept { return iterator( current + n ); }
+			iterator   operator- ( difference_type n )            const noexcept { return iterator( current - n ); }
+			difference_type operator-( const iterator & other )   const noexcept { return current - other.current; }
+			bool       operator==( const iterator & other )       const noexcept { return current == other.current; }
+			bool       operator!=( const iterator & other )       const noexcept { return current != other.current; }
+			bool       operator< ( const iterator & other )       const noexcept { return current <  other.current; }
+			bool       operator> ( const iterator & other )       const noexcept { return current >  other.current; }
+			bool       operator<=( const iterator & other )       const noexcept { return current <= other.current; }
+			bool       operator>=( const iterator & other )       const noexcept { return current >= other.current; }
+			reference  operator* ()                               const noexcept { return *current; }
+			pointer    operator->()                               const noexcept { return current; }
+			reference  operator[]( difference_type n )            const noexcept { return current[n]; }
+			friend iterator operator+( difference_type n, const iterator & it ) noexcept { return it + n; }
 		private:
 			pointer current;
 		};
@@ -144,27 +185,44 @@ namespace PointIR
 			typedef typename PointArray::const_pointer   const_pointer;
 			typedef typename PointArray::size_type       size_type;
 			typedef typename PointArray::difference_type difference_type;
-			//TODO: implement remaining operations (http://www.cplusplus.com/reference/iterator/RandomAccessIterator/)
-			//typedef std::random_access_iterator_tag iterator_category;
-
-			const_iterator( const_pointer initial )                           noexcept { current = initial; }
-			const_iterator( const iterator & other )                          noexcept { current = other.current; }
-			const_iterator( const const_iterator & other )                    noexcept { current = other.current; }
-			const_iterator & operator++()                                     noexcept { ++current; return *this; }
-			const_iterator & operator= ( const const_iterator & other )       noexcept { current = other.current; return *this; }
-			bool             operator==( const const_iterator & other ) const noexcept { return current == other.current; }
-			bool             operator!=( const const_iterator & other ) const noexcept { return current != other.current; }
-			const_reference  operator* ()                               const noexcept { return *current; }
-			const_pointer    operator->()                               const noexcept { return current; }
+			typedef const_reference                 reference;
+			typedef const_pointer                   pointer;
+			typedef std::random_access_iterator_tag iterator_category;
+
+			const_iterator()                                                        noexcept { current = nullptr; }
+			const_iterator( const_pointer initial )                                 noexcept { current = initial; }
+			const_iterator( const iterator & other )                                noexcept { current = other.current; }
+			const_iterator( const const_iterator & other )                          noexcept { current = other.current; }
+			const_iterator & operator= ( const const_iterator & other )             noexcept { current = other.current; return *this; }
+			const_iterator & operator++()                                           noexcept { ++current; return *this; }
+			const_iterator   operator++( int )                                      noexcept { return const_iterator( current++ ); }
+			const_iterator & operator--()                                           noexcept { --current; return *this; }
+			const_iterator   operator--( int )                                      noexcept { return const_iterator( current-- ); }
+			const_iterator & operator+=( difference_type n )                        noexcept { current += n; return *this; }
+			const_iterator & operator-=( difference_type n )                        noexcept { current -= n; return *this; }
+			const_iterator   operator+ ( difference_type n )                  const noexcept { return const_iterator( current + n ); }
+			const_iterator   operator- ( difference_type n )                  const noexcept { return const_iterator( current - n ); }
+			difference_type  operator- ( const const_iterator & other )       const noexcept { return current - other.current; }
+			bool             operator==( const const_iterator & other )       const noexcept { return current == other.current; }
+			bool             operator!=( const const_iterator & other )       const noexcept { return current != other.current; }
+			bool             operator< ( const const_iterator & other )       const noexcept { return current <  other.current; }
+			bool             operator> ( const const_iterator & other )       const noexcept { return current >  other.current; }
+			bool             operator<=( const const_iterator & other )       const noexcept { return current <= other.current; }
+			bool             operator>=( const const_iterator & other )       const noexcept { return current >= other.current; }
+			const_reference  operator* ()                                     const noexcept { return *current; }
+			const_pointer    operator->()                                     const noexcept { return current; }
+			const_reference  operator[]( difference_type n )                  const noexcept { return current[n]; }
+			friend const_iterator operator+( difference_type n, const const_iterator & it ) noexcept { return it + n; }
 		private:
 			const_pointer current;
 		};
 
+		/// Sets the number of points and reallocates to exactly that capacity.
 		void resize( size_type newCount )
 		{
 			if( newCount != pointArrayCapacity )
 				_resize( newCount );
-			pointArray->count = pointArrayCapacity;
+			setCount( pointArrayCapacity );
 		}
 
 		bool empty()         const noexcept { return pointArray->count == 0; }
@@ -197,16 +255,34 @@ namespace PointIR
 	private:
 		static size_t sizeInBytes( CountType size ) { return sizeof(PointIR_PointArray) + size * sizeof(PointIR_Point); }
 
+		// shared by all arrays that have never allocated - it is never written, so empty arrays can be created without allocating
+		static PointIR_PointArray * emptyArray() noexcept
+		{
+			// zero initialized as it is static - an initializer would warn about the flexible array member
+			static PointIR_PointArray empty;
+			return &empty;
+		}
+
+		// the count never exceeds the capacity - so it stays zero without storage
+		void setCount( CountType newCount ) noexcept
+		{
+			if( pointArrayCapacity )
+				pointArray->count = newCount;
+		}
+
 		void _resize( CountType newCapacity )
 		{
-			pointArray = (PointIR_PointArray*) realloc( pointArray, sizeInBytes( newCapacity ) );
-			if( !pointArray )
+			bool wasEmpty = ( pointArray == emptyArray() );
+			PointIR_PointArray * newPointArray = (PointIR_PointArray*) realloc( wasEmpty ? nullptr : pointArray, sizeInBytes( newCapacity ) );
+			if( !newPointArray )
 				throw std::bad_alloc();
+			newPointArray->count = wasEmpty ? 0 : std::min( newPointArray->count, newCapacity );
+			pointArray = newPointArray;
 			pointArrayCapacity = newCapacity;
 		}
 
 		CountType pointArrayCapacity = 0;
-		PointIR_PointArray * pointArray = nullptr;
+		PointIR_PointArray * pointArray = emptyArray();
 	};
 }
 
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTIR_POINTPACKET__INCLUDED_
+#define _POINTIR_POINTPACKET__INCLUDED_
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/*
+ * Packet formats of the point socket.
+ *
+ * Version 1 is a plain PointIR_PointArray (count followed by x/y pairs) and is sent to every client that
+ * doesn't ask for something else. To negotiate a newer version, a client sends a PointIR_PointPacketRequest
+ * right after connecting, stating the highest version it understands. The daemon sends no reply - from then
+ * on its packets are of the highest version both sides support. Packets sent before the request was read are still of version 1 -
+ * newer packets can be told apart by their magic number.
+ *
+ * Version 2 packets consist of a header followed by count points. Consumers should step through the points
+ * using headerSize and pointSize (see PointIR_PointPacket_point) so fields appended by later revisions are
+ * skipped transparently. All values are in host byte order.
+ */
+
+#define POINTIR_POINTPACKET_MAGIC   0x50495050 /* "PPIP" */
+#define POINTIR_POINTPACKET_VERSION 2
+
+typedef struct
+{
+	uint32_t magic;   /* POINTIR_POINTPACKET_MAGIC */
+	uint32_t version; /* highest version the client understands */
+} PointIR_PointPacketRequest;
+
+enum PointIR_PointState
+{
+	POINTIR_POINTSTATE_UNTRACKED = 0, /* the daemon runs without a tracker or ran out of IDs - id is -1 */
+	POINTIR_POINTSTATE_DOWN      = 1, /* the contact appeared in this frame */
+	POINTIR_POINTSTATE_MOVE      = 2, /* the contact was already present in the previous frame */
+	POINTIR_POINTSTATE_UP        = 3  /* the contact disappeared - the position is the last known one */
+};
+
+typedef struct
+{
+	uint32_t magic;      /* POINTIR_POINTPACKET_MAGIC */
+	uint16_t version;
+	uint16_t headerSize; /* offset of the first point */
+	uint32_t pointSize;  /* distance between two points */
+	uint32_t count;
+	uint64_t sequence;   /* number of the processed frame - gaps mean frames were dropped */
+	uint64_t timestamp;  /* time the frame was captured in microseconds of a monotonic clock */
+} PointIR_PointPacketHeader;
+
+typedef struct
+{
+	float x;
+	float y;
+	int32_t id;         /* tracking ID - -1 if unknown */
+	uint32_t state;     /* one of PointIR_PointState */
+	float width;        /* extents of the blob - see PointIR_Blob */
+	float height;
+	float angle;
+	float area;
+	float intensity;    /* brightest pixel of the blob - 0 to 1 */
+} PointIR_PointPacketPoint;
+
+
+static inline const PointIR_PointPacketPoint * PointIR_PointPacket_point( const PointIR_PointPacketHeader * header, uint32_t index )
+{
+	return (const PointIR_PointPacketPoint *)( (const uint8_t *)header + header->headerSize + (size_t)index * header->pointSize );
+}
+
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTIR_SHAREDFRAMERING__INCLUDED_
+#define _POINTIR_SHAREDFRAMERING__INCLUDED_
+
+
+#include <PointIR/Frame.h>
+#include <stdint.h>
+
+
+/*
+ * Layout of the shared memory object the "shm" frame output publishes into.
+ *
+ * Frames are written into one of several slots - each slot holds a PointIR_Frame followed by its data.
+ * Only the producer may write the ring. Readers pin the slot they are reading in a second object -
+ * named like the ring with POINTIR_SHAREDFRAMERING_READERS_SUFFIX appended - and the producer only
+ * writes into slots nobody reads. Each reader first claims an entry of that object by storing its
+ * process ID, then pins at most one slot at a time through the entry. Entries of processes that no
+ * longer exist are reclaimed, so a crashed reader can't keep a slot pinned: readers take them over
+ * with a compare and swap of the PID, the producer first swaps in POINTIR_SHAREDFRAMERING_RECLAIMING,
+ * clears the pin and then frees the entry.
+ * Both objects are only accessible to the user and group of the producer.
+ * The sequence counter of a slot is odd while it is written.
+ * When the frame size exceeds the slot size the producer replaces both objects with larger ones and
+ * makes the generation of the old ring odd - readers notice this and map the new objects. Readers only
+ * use a ring with an even generation that matches the one of the reader counts.
+ * All shared counters are accessed with atomic operations.
+ */
+
+#define POINTIR_SHAREDFRAMERING_MAGIC       0x50495246 /* "PIRF" */
+#define POINTIR_SHAREDFRAMERING_VERSION     2
+#define POINTIR_SHAREDFRAMERING_SLOTS       4
+#define POINTIR_SHAREDFRAMERING_READERS     16
+#define POINTIR_SHAREDFRAMERING_RECLAIMING  0xffffffff /* PID of an entry the producer is freeing */
+#define POINTIR_SHAREDFRAMERING_DATA_OFFSET 4096 /* slot i starts at DATA_OFFSET + i * slotSize */
+#define POINTIR_SHAREDFRAMERING_READERS_SUFFIX ".readers"
+
+typedef struct
+{
+	uint32_t sequence;
+} PointIR_SharedFrameRing_Slot;
+
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t generation;
+	uint32_t slotCount;
+	uint32_t slotSize;  /* in bytes - includes the PointIR_Frame header */
+	uint32_t latest;    /* index of the slot holding the latest frame */
+	uint32_t published; /* number of published frames - 0 if latest is not valid yet */
+	PointIR_SharedFrameRing_Slot slots[POINTIR_SHAREDFRAMERING_SLOTS];
+} PointIR_SharedFrameRing;
+
+typedef struct
+{
+	uint32_t pid;  /* of the reader owning this entry - 0 if the entry is free */
+	uint32_t slot; /* index of the pinned slot plus one - 0 if no slot is pinned */
+} PointIR_SharedFrameRing_Reader;
+
+typedef struct
+{
+	uint32_t generation; /* of the ring these entries belong to */
+	PointIR_SharedFrameRing_Reader readers[POINTIR_SHAREDFRAMERING_READERS];
+} PointIR_SharedFrameRing_Readers;
+
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTIR_SHAREDPOINTRING__INCLUDED_
+#define _POINTIR_SHAREDPOINTRING__INCLUDED_
+
+
+#include <PointIR/Point.h>
+#include <stdint.h>
+
+
+/*
+ * Layout of the shared memory object the "shm" point output publishes into.
+ *
+ * The producer writes each point array into the next slot of the ring and then increments head.
+ * Every slot is guarded by a sequence counter which is odd while the slot is written (seqlock),
+ * so readers detect and retry torn reads without ever blocking the producer.
+ * Only the producer writes the ring - readers map it read only. Readers waiting for new points increment
+ * the counter in a second object - named like the ring with POINTIR_SHAREDPOINTRING_WAITERS_SUFFIX
+ * appended - and sleep on head with a futex. Both objects are only accessible to the user and group
+ * of the producer. The producer only issues the wake syscall if
+ * the counter is non-zero.
+ * All shared counters are accessed with atomic operations.
+ */
+
+#define POINTIR_SHAREDPOINTRING_MAGIC      0x50495250 /* "PIRP" */
+#define POINTIR_SHAREDPOINTRING_VERSION    2
+#define POINTIR_SHAREDPOINTRING_WAITERS_SUFFIX ".waiters"
+#define POINTIR_SHAREDPOINTRING_SLOTS      8
+#define POINTIR_SHAREDPOINTRING_MAX_POINTS 64
+
+typedef struct
+{
+	uint32_t sequence;
+	uint32_t count;
+	PointIR_Point points[POINTIR_SHAREDPOINTRING_MAX_POINTS];
+} PointIR_SharedPointRing_Slot;
+
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t slotCount;
+	uint32_t maxPoints;
+	uint32_t head;    /* number of published point arrays - the latest is in slot ( head - 1 ) % slotCount */
+	PointIR_SharedPointRing_Slot slots[POINTIR_SHAREDPOINTRING_SLOTS];
+} PointIR_SharedPointRing;
+
+typedef struct
+{
+	uint32_t waiters; /* number of readers sleeping on head */
+} PointIR_SharedPointRing_Waiters;
+
+
+#if __cplusplus
+
+#include <PointIR/PointArray.h>
+
+#include <string>
+#include <system_error>
+#include <stdexcept>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include <linux/futex.h>
+
+namespace PointIR
+{
+	/// Reads points published by the "shm" point output of pointird.
+	class SharedPointRing
+	{
+	public:
+		SharedPointRing( const SharedPointRing & ) = delete; // disable copy constructor
+		SharedPointRing & operator=( const SharedPointRing & other ) = delete; // disable assignment operator
+
+		SharedPointRing( const std::string & name = "/PointIR.points" )
+		{
+			ring = static_cast< PointIR_SharedPointRing * >( map( name, sizeof(PointIR_SharedPointRing), false ) );
+			if( ring->magic != POINTIR_SHAREDPOINTRING_MAGIC || ring->version != POINTIR_SHAREDPOINTRING_VERSION
+			 || ring->slotCount != POINTIR_SHAREDPOINTRING_SLOTS || ring->maxPoints != POINTIR_SHAREDPOINTRING_MAX_POINTS )
+			{
+				munmap( ring, sizeof(PointIR_SharedPointRing) );
+				throw std::runtime_error( "\"" + name + "\" is not a compatible PointIR shared point ring" );
+			}
+
+			try
+			{
+				waiters = static_cast< PointIR_SharedPointRing_Waiters * >(
+					map( name + POINTIR_SHAREDPOINTRING_WAITERS_SUFFIX, sizeof(PointIR_SharedPointRing_Waiters), true ) );
+			}
+			catch( ... )
+			{
+				munmap( ring, sizeof(PointIR_SharedPointRing) );
+				throw;
+			}
+
+			lastHead = __atomic_load_n( &ring->head, __ATOMIC_ACQUIRE );
+		}
+
+		~SharedPointRing()
+		{
+			munmap( waiters, sizeof(PointIR_SharedPointRing_Waiters) );
+			munmap( ring, sizeof(PointIR_SharedPointRing) );
+		}
+
+		/// Returns true if points were published since the last call to read.
+		bool hasNewPoints() const
+		{
+			return __atomic_load_n( &ring->head, __ATOMIC_ACQUIRE ) != lastHead;
+		}
+
+		/// Blocks until new points are published or the timeout (in milliseconds, negative waits forever) expired.
+		bool waitForPoints( int timeoutMs = -1 ) const
+		{
+			uint32_t head = __atomic_load_n( &ring->head, __ATOMIC_ACQUIRE );
+			if( head != lastHead )
+				return true;
+
+			struct timespec timeout;
+			timeout.tv_sec = timeoutMs / 1000;
+			timeout.tv_nsec = ( timeoutMs % 1000 ) * 1000000L;
+
+			__atomic_add_fetch( &waiters->waiters, 1, __ATOMIC_SEQ_CST );
+			// the kernel compares head again before sleeping - a concurrent publish can't get lost
+			long r = syscall( SYS_futex, &ring->head, FUTEX_WAIT, head, (timeoutMs < 0) ? nullptr : &timeout, nullptr, 0 );
+			int waitErrno = errno;
+			__atomic_sub_fetch( &waiters->waiters, 1, __ATOMIC_SEQ_CST );
+			if( -1 == r && EAGAIN != waitErrno && EINTR != waitErrno && ETIMEDOUT != waitErrno )
+				throw std::system_error( waitErrno, std::system_category(), "futex(FUTEX_WAIT)" );
+
+			return __atomic_load_n( &ring->head, __ATOMIC_ACQUIRE ) != lastHead;
+		}
+
+		/// Copies the latest published points - returns false if nothing was published yet.
+		bool read( PointArray & pointArray )
+		{
+			while( true )
+			{
+				uint32_t head = __atomic_load_n( &ring->head, __ATOMIC_ACQUIRE );
+				if( !head )
+					return false;
+				const PointIR_SharedPointRing_Slot & slot = ring->slots[ ( head - 1 ) % POINTIR_SHAREDPOINTRING_SLOTS ];
+
+				uint32_t sequence = __atomic_load_n( &slot.sequence, __ATOMIC_ACQUIRE );
+				if( sequence & 1 )
+					continue; // producer lapped us and is writing this slot
+
+				uint32_t count = __atomic_load_n( &slot.count, __ATOMIC_RELAXED );
+				if( count > POINTIR_SHAREDPOINTRING_MAX_POINTS )
+					continue; // torn read
+				pointArray.resizeIfNeeded( count );
+				memcpy( static_cast< void * >( pointArray.data() ), slot.points, count * sizeof(PointIR_Point) );
+
+				__atomic_thread_fence( __ATOMIC_ACQUIRE );
+				if( __atomic_load_n( &slot.sequence, __ATOMIC_RELAXED ) != sequence )
+					continue; // slot was overwritten while copying
+
+				lastHead = head;
+				return true;
+			}
+		}
+
+	private:
+		PointIR_SharedPointRing * ring = nullptr; // mapped read only
+		PointIR_SharedPointRing_Waiters * waiters = nullptr;
+		uint32_t lastHead = 0;
+
+		static void * map( const std::string & name, size_t size, bool writable )
+		{
+			int fd = shm_open( name.c_str(), writable ? O_RDWR : O_RDONLY, 0 );
+			if( -1 == fd )
+				throw std::system_error( errno, std::system_category(), "shm_open(\"" + name + "\")" );
+
+			void * mapping = mmap( nullptr, size, writable ? ( PROT_READ | PROT_WRITE ) : PROT_READ, MAP_SHARED, fd, 0 );
+			int mmapErrno = errno;
+			close( fd );
+			if( MAP_FAILED == mapping )
+				throw std::system_error( mmapErrno, std::system_category(), "mmap(\"" + name + "\")" );
+			return mapping;
+		}
+	};
+}
+
+#endif
+
+
+#endif
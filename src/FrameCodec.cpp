@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameCodec.hpp"
+
+#include <algorithm>
+
+#include <string.h>
+
+
+using namespace PointIR;
+
+
+static const uint32_t magic = 0x43524950; // "PIRC"
+static const size_t headerSize = 16;
+
+enum Flags : uint8_t
+{
+	KEYFRAME = 0x01,
+};
+
+// token classes - the lower 6 bits hold the run length minus one
+enum Token : uint8_t
+{
+	ZEROS   = 0x00,
+	NIBBLES = 0x40,
+	BYTES   = 0x80,
+	LONGZEROS = 0xc0, // followed by one more byte of run length
+};
+
+static const size_t maxRun = 64;
+static const size_t maxLongRun = 64 * 256;
+
+
+static void put32( std::vector< uint8_t > & out, uint32_t value )
+{
+	for( int i = 0; i < 4; i++ )
+		out.push_back( ( value >> ( i * 8 ) ) & 0xff );
+}
+
+
+static uint32_t get32( const uint8_t * data )
+{
+	return data[0] | ( data[1] << 8 ) | ( data[2] << 16 ) | ( (uint32_t)data[3] << 24 );
+}
+
+
+static bool isNibble( uint8_t residual )
+{
+	return (int8_t)residual >= -8 && (int8_t)residual <= 7;
+}
+
+
+void FrameEncoder::encode( const Frame & frame, std::vector< uint8_t > & out )
+{
+	size_t size = frame.size();
+	bool keyFrame = this->keyFrameRequested || frame.getWidth() != this->previousWidth || frame.getHeight() != this->previousHeight;
+	this->keyFrameRequested = false;
+
+	// residuals against the previous frame - which is updated in the same pass
+	// walks the rows, as the rows of the frame may be padded while residuals and previous are packed
+	this->residuals.resize( size );
+	this->previous.resize( size, 0 );
+	size_t index = 0;
+	for( unsigned int y = 0; y < frame.getHeight(); y++ )
+	{
+		const uint8_t * row = frame.getRow( y );
+		for( unsigned int x = 0; x < frame.getWidth(); x++, index++ )
+		{
+			uint8_t pixel = ( row[x] > this->noiseFloor ) ? row[x] : 0;
+			this->residuals[index] = keyFrame ? pixel : (uint8_t)( pixel - this->previous[index] );
+			this->previous[index] = pixel;
+		}
+	}
+	this->previousWidth = frame.getWidth();
+	this->previousHeight = frame.getHeight();
+
+	out.clear();
+	put32( out, magic );
+	put32( out, frame.getWidth() );
+	put32( out, frame.getHeight() );
+	put32( out, keyFrame ? KEYFRAME : 0 );
+
+	const uint8_t * residual = this->residuals.data();
+	size_t i = 0;
+	while( i < size )
+	{
+		// zeros
+		size_t run = 0;
+		while( i + run < size && run < maxLongRun && !residual[i+run] )
+			run++;
+		if( run )
+		{
+			if( run > maxRun )
+			{
+				out.push_back( LONGZEROS | ( ( run - 1 ) >> 8 ) );
+				out.push_back( ( run - 1 ) & 0xff );
+			}
+			else
+				out.push_back( ZEROS | ( run - 1 ) );
+			i += run;
+			continue;
+		}
+
+		// small values - a single zero inside does not end the run as two tokens would cost more
+		run = 0;
+		while( i + run < size && run < maxRun && isNibble( residual[i+run] )
+		    && ( residual[i+run] || ( i + run + 1 < size && residual[i+run+1] && isNibble( residual[i+run+1] ) ) ) )
+			run++;
+		if( run >= 2 )
+		{
+			out.push_back( NIBBLES | ( run - 1 ) );
+			for( size_t n = 0; n < run; n += 2 )
+			{
+				uint8_t packed = residual[i+n] & 0x0f;
+				if( n + 1 < run )
+					packed |= ( residual[i+n+1] & 0x0f ) << 4;
+				out.push_back( packed );
+			}
+			i += run;
+			continue;
+		}
+
+		// everything else
+		run = 1;
+		while( i + run < size && run < maxRun && residual[i+run] && !( isNibble( residual[i+run] ) && i + run + 1 < size && isNibble( residual[i+run+1] ) ) )
+			run++;
+		out.push_back( BYTES | ( run - 1 ) );
+		out.insert( out.end(), residual + i, residual + i + run );
+		i += run;
+	}
+}
+
+
+bool FrameDecoder::decode( const uint8_t * data, size_t size, Frame & frame )
+{
+	if( size < headerSize || get32( data ) != magic )
+		return false;
+
+	uint32_t width = get32( data + 4 );
+	uint32_t height = get32( data + 8 );
+	bool keyFrame = get32( data + 12 ) & KEYFRAME;
+
+	if( !keyFrame && ( !this->hasKeyFrame || width != this->previousWidth || height != this->previousHeight ) )
+		return false;
+
+	size_t pixels = (size_t)width * height;
+	this->previous.resize( pixels );
+	if( keyFrame )
+		std::fill( this->previous.begin(), this->previous.end(), 0 );
+
+	const uint8_t * in = data + headerSize;
+	const uint8_t * end = data + size;
+	uint8_t * pixel = this->previous.data();
+	size_t i = 0;
+	while( i < pixels )
+	{
+		if( in >= end )
+			break;
+		uint8_t token = *in++;
+		size_t run = ( token & 0x3f ) + 1;
+		switch( token & 0xc0 )
+		{
+		case LONGZEROS:
+			if( in >= end )
+				break;
+			run = ( ( token & 0x3f ) << 8 | *in++ ) + 1;
+			// fall through
+		case ZEROS:
+			i += run;
+			break;
+		case NIBBLES:
+			if( i + run > pixels || in + ( run + 1 ) / 2 > end )
+				break;
+			for( size_t n = 0; n < run; n++ )
+			{
+				int8_t value = ( in[n/2] >> ( ( n & 1 ) * 4 ) ) & 0x0f;
+				if( value & 0x08 )
+					value -= 16;
+				pixel[i+n] += value;
+			}
+			in += ( run + 1 ) / 2;
+			i += run;
+			break;
+		case BYTES:
+			if( i + run > pixels || in + run > end )
+				break;
+			for( size_t n = 0; n < run; n++ )
+				pixel[i+n] += in[n];
+			in += run;
+			i += run;
+			break;
+		}
+	}
+
+	if( i != pixels || in != end )
+	{ // corrupt - wait for the next key frame
+		this->hasKeyFrame = false;
+		return false;
+	}
+
+	this->hasKeyFrame = true;
+	this->previousWidth = width;
+	this->previousHeight = height;
+
+	frame.resize( width, height );
+	memcpy( frame.getData(), this->previous.data(), pixels );
+	return true;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTIR_FRAMECODEC__INCLUDED_
+#define _POINTIR_FRAMECODEC__INCLUDED_
+
+
+#include <PointIR/Frame.h>
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+
+/*
+ * Lossless compression for sparse greyscale frames.
+ *
+ * Each pixel is predicted from the same pixel of the previous frame (delta frames) or predicted as black (key frames).
+ * The residuals are coded as runs of zeros, runs of small values packed into nibbles, or runs of literal bytes.
+ * Static or dark parts of an IR image therefore cost next to nothing.
+ *
+ * Encoded frames start with a header of four little endian uint32: magic, width, height and flags.
+ */
+
+
+namespace PointIR
+{
+	class FrameEncoder
+	{
+	public:
+		/// Pixels at or below the noise floor are sent as black - 0 keeps the compression lossless.
+		void setNoiseFloor( uint8_t noiseFloor ) { this->noiseFloor = noiseFloor; }
+		uint8_t getNoiseFloor() const { return this->noiseFloor; }
+
+		/// Makes the next frame a key frame - decoders can only start at key frames.
+		void requestKeyFrame() { this->keyFrameRequested = true; }
+
+		/// Replaces the contents of out with the encoded frame.
+		void encode( const Frame & frame, std::vector< uint8_t > & out );
+
+	private:
+		std::vector< uint8_t > previous;
+		std::vector< uint8_t > residuals;
+		Frame::WidthType previousWidth = 0;
+		Frame::HeightType previousHeight = 0;
+		uint8_t noiseFloor = 0;
+		bool keyFrameRequested = true;
+	};
+
+
+	class FrameDecoder
+	{
+	public:
+		/// Returns false for corrupt data or delta frames without preceding key frame.
+		bool decode( const uint8_t * data, size_t size, Frame & frame );
+
+	private:
+		std::vector< uint8_t > previous;
+		Frame::WidthType previousWidth = 0;
+		Frame::HeightType previousHeight = 0;
+		bool hasKeyFrame = false;
+	};
+}
+
+
+#endif
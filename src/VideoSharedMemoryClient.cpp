@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "VideoSharedMemoryClient.hpp"
+
+
+#ifndef __unix__
+//TODO: implement for non unix platforms
+using namespace PointIR;
+class VideoSharedMemoryClient::Impl{};
+VideoSharedMemoryClient::VideoSharedMemoryClient( const std::string & name ) : pImpl( new Impl ) {}
+VideoSharedMemoryClient::~VideoSharedMemoryClient() {}
+bool VideoSharedMemoryClient::isAvailable() const { return false; }
+const PointIR_Frame * VideoSharedMemoryClient::acquireFrame() const { return nullptr; }
+void VideoSharedMemoryClient::releaseFrame() const {}
+bool VideoSharedMemoryClient::receiveFrame( Frame & frame ) const { return false; }
+#else
+
+
+#include <PointIR/SharedFrameRing.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+#define SYSTEM_ERROR( errornumber, whattext ) \
+std::system_error( (errornumber), std::system_category(), std::string(__PRETTY_FUNCTION__) + std::string(": ") + (whattext) )
+
+
+using namespace PointIR;
+
+
+class VideoSharedMemoryClient::Impl
+{
+private:
+	mutable PointIR_SharedFrameRing * ring = nullptr; // mapped read only
+	mutable PointIR_SharedFrameRing_Readers * readers = nullptr;
+	mutable PointIR_SharedFrameRing_Reader * entry = nullptr; // claimed in readers
+	mutable size_t mappingSize = 0;
+	mutable uint32_t generation = 0;
+	mutable uint32_t lastPublished = 0;
+	mutable int pinnedSlot = -1;
+
+	void unmap() const
+	{
+		this->releaseFrame();
+		__atomic_store_n( &this->entry->pid, 0, __ATOMIC_SEQ_CST );
+		munmap( this->ring, this->mappingSize );
+		munmap( this->readers, sizeof(PointIR_SharedFrameRing_Readers) );
+		this->ring = nullptr;
+		this->readers = nullptr;
+		this->entry = nullptr;
+		this->mappingSize = 0;
+	}
+
+	/// Takes a free entry or one of a process that is gone - returns nullptr if all are in use.
+	static PointIR_SharedFrameRing_Reader * claimEntry( PointIR_SharedFrameRing_Readers * readers )
+	{
+		uint32_t self = getpid();
+		for( PointIR_SharedFrameRing_Reader & reader : readers->readers )
+		{
+			uint32_t pid = __atomic_load_n( &reader.pid, __ATOMIC_SEQ_CST );
+			if( pid && ( POINTIR_SHAREDFRAMERING_RECLAIMING == pid || -1 != kill( pid, 0 ) || ESRCH != errno ) )
+				continue;
+			if( !__atomic_compare_exchange_n( &reader.pid, &pid, self, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) )
+				continue;
+			__atomic_store_n( &reader.slot, 0, __ATOMIC_SEQ_CST ); // a crashed owner may have left its pin
+			return &reader;
+		}
+		return nullptr;
+	}
+
+public:
+	std::string name;
+
+	Impl() {}
+
+	~Impl()
+	{
+		if( this->ring )
+			this->unmap();
+	}
+
+	bool mapIfNeeded() const
+	{
+		if( this->ring )
+		{
+			// the producer replaced the object (e.g. because the frame size changed)
+			if( __atomic_load_n( &this->ring->generation, __ATOMIC_ACQUIRE ) == this->generation )
+				return true;
+			this->unmap();
+		}
+
+		int fd = shm_open( this->name.c_str(), O_RDONLY, 0 );
+		if( -1 == fd )
+		{
+			if( ENOENT == errno )
+				return false; // no producer running
+			throw SYSTEM_ERROR( errno, "shm_open(\"" + this->name + "\")" );
+		}
+
+		struct stat st;
+		if( -1 == fstat( fd, &st ) )
+		{
+			int error = errno;
+			close( fd );
+			throw SYSTEM_ERROR( error, "fstat(\"" + this->name + "\")" );
+		}
+		if( (size_t)st.st_size < POINTIR_SHAREDFRAMERING_DATA_OFFSET )
+		{ // producer is still setting up
+			close( fd );
+			return false;
+		}
+
+		void * mapping = mmap( nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+		int error = errno;
+		close( fd );
+		if( MAP_FAILED == mapping )
+			throw SYSTEM_ERROR( error, "mmap(\"" + this->name + "\")" );
+
+		PointIR_SharedFrameRing * ring = static_cast< PointIR_SharedFrameRing * >( mapping );
+		if( __atomic_load_n( &ring->magic, __ATOMIC_ACQUIRE ) != POINTIR_SHAREDFRAMERING_MAGIC
+		 || ring->version != POINTIR_SHAREDFRAMERING_VERSION
+		 || ring->slotCount != POINTIR_SHAREDFRAMERING_SLOTS
+		 || (size_t)st.st_size < POINTIR_SHAREDFRAMERING_DATA_OFFSET + POINTIR_SHAREDFRAMERING_SLOTS * (size_t)ring->slotSize )
+		{
+			munmap( mapping, st.st_size );
+			return false;
+		}
+
+		std::string readersName = this->name + POINTIR_SHAREDFRAMERING_READERS_SUFFIX;
+		fd = shm_open( readersName.c_str(), O_RDWR, 0 );
+		if( -1 == fd )
+		{
+			error = errno;
+			munmap( mapping, st.st_size );
+			if( ENOENT == error )
+				return false; // producer is replacing the objects
+			throw SYSTEM_ERROR( error, "shm_open(\"" + readersName + "\")" );
+		}
+		void * readersMapping = mmap( nullptr, sizeof(PointIR_SharedFrameRing_Readers), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+		error = errno;
+		close( fd );
+		if( MAP_FAILED == readersMapping )
+		{
+			munmap( mapping, st.st_size );
+			throw SYSTEM_ERROR( error, "mmap(\"" + readersName + "\")" );
+		}
+		PointIR_SharedFrameRing_Readers * readers = static_cast< PointIR_SharedFrameRing_Readers * >( readersMapping );
+
+		// an odd generation marks a replaced ring - the reader entries may already belong to its successor
+		uint32_t generation = __atomic_load_n( &ring->generation, __ATOMIC_ACQUIRE );
+		if( ( generation & 1 ) || __atomic_load_n( &readers->generation, __ATOMIC_ACQUIRE ) != generation )
+		{
+			munmap( readersMapping, sizeof(PointIR_SharedFrameRing_Readers) );
+			munmap( mapping, st.st_size );
+			return false;
+		}
+
+		PointIR_SharedFrameRing_Reader * entry = claimEntry( readers );
+		if( !entry )
+		{
+			munmap( readersMapping, sizeof(PointIR_SharedFrameRing_Readers) );
+			munmap( mapping, st.st_size );
+			throw std::runtime_error( "all " + std::to_string( POINTIR_SHAREDFRAMERING_READERS ) + " reader entries of \"" + readersName + "\" are in use" );
+		}
+
+		this->ring = ring;
+		this->readers = readers;
+		this->entry = entry;
+		this->mappingSize = st.st_size;
+		this->generation = generation;
+		this->lastPublished = 0;
+		return true;
+	}
+
+	const PointIR_Frame * acquireFrame() const
+	{
+		if( !this->mapIfNeeded() )
+			return nullptr;
+
+		while( true )
+		{
+			// reading the counter before the slot index may deliver a frame twice, but never skips the latest one
+			uint32_t published = __atomic_load_n( &this->ring->published, __ATOMIC_ACQUIRE );
+			if( !published || published == this->lastPublished )
+				return nullptr;
+			uint32_t index = __atomic_load_n( &this->ring->latest, __ATOMIC_ACQUIRE ) % POINTIR_SHAREDFRAMERING_SLOTS;
+
+			PointIR_SharedFrameRing_Slot & slot = this->ring->slots[index];
+			uint32_t sequence = __atomic_load_n( &slot.sequence, __ATOMIC_ACQUIRE );
+			if( sequence & 1 )
+				continue;
+
+			// pin the slot, then make sure the producer didn't start overwriting it meanwhile
+			this->releaseFrame();
+			__atomic_store_n( &this->entry->slot, index + 1, __ATOMIC_SEQ_CST );
+			if( __atomic_load_n( &slot.sequence, __ATOMIC_SEQ_CST ) != sequence )
+			{
+				__atomic_store_n( &this->entry->slot, 0, __ATOMIC_SEQ_CST );
+				continue;
+			}
+			this->pinnedSlot = index;
+			this->lastPublished = published;
+
+			return reinterpret_cast< const PointIR_Frame * >(
+				reinterpret_cast< const uint8_t * >( this->ring ) + POINTIR_SHAREDFRAMERING_DATA_OFFSET + index * this->ring->slotSize );
+		}
+	}
+
+	void releaseFrame() const
+	{
+		if( this->pinnedSlot < 0 )
+			return;
+		__atomic_store_n( &this->entry->slot, 0, __ATOMIC_SEQ_CST );
+		this->pinnedSlot = -1;
+	}
+};
+
+
+VideoSharedMemoryClient::VideoSharedMemoryClient( const std::string & name ) : pImpl( new Impl )
+{
+	this->pImpl->name = name;
+}
+
+
+VideoSharedMemoryClient::~VideoSharedMemoryClient()
+{
+}
+
+
+bool VideoSharedMemoryClient::isAvailable() const
+{
+	return this->pImpl->mapIfNeeded();
+}
+
+
+const PointIR_Frame * VideoSharedMemoryClient::acquireFrame() const
+{
+	return this->pImpl->acquireFrame();
+}
+
+
+void VideoSharedMemoryClient::releaseFrame() const
+{
+	this->pImpl->releaseFrame();
+}
+
+
+bool VideoSharedMemoryClient::receiveFrame( Frame & frame ) const
+{
+	const PointIR_Frame * shared = this->pImpl->acquireFrame();
+	if( !shared )
+		return false;
+	frame.resize( shared->width, shared->height );
+	memcpy( frame.getData(), shared->data, frame.size() );
+	this->pImpl->releaseFrame();
+	return true;
+}
+
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTIR_VIDEOSHAREDMEMORYCLIENT__INCLUDED_
+#define _POINTIR_VIDEOSHAREDMEMORYCLIENT__INCLUDED_
+
+
+#include <PointIR/Frame.h>
+
+#include <string>
+#include <memory>
+
+
+namespace PointIR
+{
+	/// Reads frames published by the "shm" frame output of pointird without copying them.
+	class VideoSharedMemoryClient
+	{
+	public:
+		VideoSharedMemoryClient( const std::string & name = "/PointIR.video" );
+		virtual ~VideoSharedMemoryClient();
+
+		/// Returns true if the shared memory object exists - tries to map it if not done yet.
+		bool isAvailable() const;
+
+		/// Returns the latest frame if it wasn't acquired before, nullptr otherwise.
+		/// The frame stays valid until releaseFrame is called or another frame is acquired.
+		const PointIR_Frame * acquireFrame() const;
+		void releaseFrame() const;
+
+		/// Copies the latest frame - for compatibility with VideoSocketClient.
+		bool receiveFrame( Frame & frame ) const;
+	private:
+		class Impl;
+		std::unique_ptr< Impl > pImpl;
+	};
+}
+
+
+#endif
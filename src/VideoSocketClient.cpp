@@ -18,6 +18,7 @@
  */
 
 #include "VideoSocketClient.hpp"
+#include "FrameCodec.hpp"
 
 
 #ifndef __unix__
@@ -27,20 +28,26 @@ class VideoSocketClient::Impl{};
 VideoSocketClient::VideoSocketClient( const std::string & path ) : pImpl( new Impl ) {}
 VideoSocketClient::~VideoSocketClient() {}
 bool VideoSocketClient::receiveFrame( Frame & frame ) const { return false; }
+void VideoSocketClient::setFrameRequest( const PointIR_FrameRequest & request ) {}
 #else
 
 
 #include <iostream>
 #include <stdexcept>
 #include <system_error>
+#include <vector>
+#include <algorithm>
 
+#include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <netdb.h>
 
 
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/uio.h>
 
 
 #define SYSTEM_ERROR( errornumber, whattext ) \
@@ -53,13 +60,115 @@ std::runtime_error( std::string(__PRETTY_FUNCTION__) + std::string(": ") + (what
 using namespace PointIR;
 
 
+static const std::string streamPrefix = "tcp://";
+
+
 class VideoSocketClient::Impl
 {
 private:
 	mutable int socketFD = 0;
 
+	// compressed TCP stream
+	mutable FrameDecoder decoder;
+	mutable std::vector< uint8_t > streamBuffer;
+
+	void disconnect() const
+	{
+		close( this->socketFD );
+		this->socketFD = 0;
+	}
+
+	bool connectStreamIfNeeded() const
+	{
+		if( this->socketFD )
+			return true;
+
+		std::string address = this->socketName.substr( streamPrefix.size() );
+		size_t separator = address.rfind( ':' );
+		if( std::string::npos == separator )
+			throw RUNTIME_ERROR( "address \"" + address + "\" is not of the form host:port" );
+
+		struct addrinfo hints = {};
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		struct addrinfo * addresses = nullptr;
+		if( getaddrinfo( address.substr( 0, separator ).c_str(), address.substr( separator + 1 ).c_str(), &hints, &addresses ) )
+			return false;
+
+		this->socketFD = socket( addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol );
+		if( -1 == this->socketFD )
+		{
+			this->socketFD = 0;
+			freeaddrinfo( addresses );
+			throw SYSTEM_ERROR( errno, "socket" );
+		}
+
+		// connect nonblocking - errors show up when receiving
+		int flags = fcntl( this->socketFD, F_GETFL, 0 );
+		if( -1 == flags || -1 == fcntl( this->socketFD, F_SETFL, flags | O_NONBLOCK ) )
+		{
+			freeaddrinfo( addresses );
+			this->disconnect();
+			throw SYSTEM_ERROR( errno, "fcntl" );
+		}
+		int connected = connect( this->socketFD, addresses->ai_addr, addresses->ai_addrlen );
+		freeaddrinfo( addresses );
+		if( -1 == connected && EINPROGRESS != errno )
+		{
+			this->disconnect();
+			return false;
+		}
+
+		this->streamBuffer.clear();
+		return true;
+	}
+
+	bool receiveStreamFrame( Frame & frame ) const
+	{
+		if( !this->connectStreamIfNeeded() )
+			return false;
+
+		// take everything available
+		while( true )
+		{
+			size_t size = this->streamBuffer.size();
+			this->streamBuffer.resize( size + 65536 );
+			ssize_t received = recv( this->socketFD, this->streamBuffer.data() + size, 65536, 0 );
+			this->streamBuffer.resize( size + std::max< ssize_t >( received, 0 ) );
+			if( -1 == received )
+			{
+				if( EAGAIN == errno || EWOULDBLOCK == errno )
+					break;
+				this->disconnect(); // refused or reset - try again on the next call
+				return false;
+			}
+			if( 0 == received )
+			{
+				this->disconnect();
+				break;
+			}
+		}
+
+		// decode all complete messages - delta frames depend on each other
+		bool decoded = false;
+		size_t offset = 0;
+		while( this->streamBuffer.size() - offset >= 4 )
+		{
+			const uint8_t * message = this->streamBuffer.data() + offset;
+			uint32_t length = message[0] | ( message[1] << 8 ) | ( message[2] << 16 ) | ( (uint32_t)message[3] << 24 );
+			if( this->streamBuffer.size() - offset - 4 < length )
+				break;
+			decoded |= this->decoder.decode( message + 4, length, frame );
+			offset += 4 + length;
+		}
+		this->streamBuffer.erase( this->streamBuffer.begin(), this->streamBuffer.begin() + offset );
+		return decoded;
+	}
+
 public:
 	std::string socketName;
+	PointIR_FrameRequest request = {};
+	bool hasRequest = false;
 
 	Impl() {}
 
@@ -69,6 +178,11 @@ public:
 			close( this->socketFD );
 	}
 
+	bool isStream() const
+	{
+		return 0 == this->socketName.compare( 0, streamPrefix.size(), streamPrefix );
+	}
+
 	bool connectIfNeeded() const
 	{
 		if( this->socketFD )
@@ -100,11 +214,26 @@ public:
 			return false;
 		}
 
+		this->sendRequest();
 		return true;
 	}
 
+	void sendRequest() const
+	{
+		if( !this->socketFD || !this->hasRequest || this->isStream() )
+			return;
+		if( -1 == send( this->socketFD, &this->request, sizeof(this->request), MSG_NOSIGNAL ) )
+		{ // reconnect and send again on the next frame
+			close( this->socketFD );
+			this->socketFD = 0;
+		}
+	}
+
 	bool receiveFrame( Frame & frame ) const
 	{
+		if( this->isStream() )
+			return this->receiveStreamFrame( frame );
+
 		if( !this->connectIfNeeded() )
 			return false;
 
@@ -135,10 +264,18 @@ public:
 		// resize packet buffer if needed
 		frame.resize( peek.width, peek.height );
 
-		// receive the packet
-		received = recv( this->socketFD, (PointIR_Frame*)frame, sizeof(PointIR_Frame)+frame.size(), 0 );
+		// receive the packet - the header separately, so the pixels go straight into the frame
+		struct iovec parts[2];
+		parts[0].iov_base = &peek;
+		parts[0].iov_len = sizeof(PointIR_Frame);
+		parts[1].iov_base = frame.getData();
+		parts[1].iov_len = frame.size();
+		struct msghdr message = {};
+		message.msg_iov = parts;
+		message.msg_iovlen = 2;
+		received = recvmsg( this->socketFD, &message, 0 );
 		if( -1 == received )
-			throw SYSTEM_ERROR( errno, "recv" );
+			throw SYSTEM_ERROR( errno, "recvmsg" );
 		if( sizeof(PointIR_Frame)+frame.size() != (size_t)received )
 		{
 //			throw RUNTIME_ERROR( "too few data received" );
@@ -168,4 +305,12 @@ bool VideoSocketClient::receiveFrame( Frame & frame ) const
 }
 
 
+void VideoSocketClient::setFrameRequest( const PointIR_FrameRequest & request )
+{
+	this->pImpl->request = request;
+	this->pImpl->hasRequest = true;
+	this->pImpl->sendRequest();
+}
+
+
 #endif
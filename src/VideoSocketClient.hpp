@@ -22,6 +22,7 @@
 
 
 #include <PointIR/Frame.h>
+#include <PointIR/FrameRequest.h>
 
 #include <string>
 #include <memory>
@@ -32,9 +33,14 @@ namespace PointIR
 	class VideoSocketClient
 	{
 	public:
+		/// Paths of the form "tcp://host:port" connect to the compressed frame stream of the daemon.
 		VideoSocketClient( const std::string & path = "/tmp/PointIR.video.socket" );
 		virtual ~VideoSocketClient();
 		bool receiveFrame( Frame & frame ) const;
+
+		/// Tells the daemon which frames to send - applies to the current and all future connections.
+		/// Not supported by the compressed frame stream.
+		void setFrameRequest( const PointIR_FrameRequest & request );
 	private:
 		class Impl;
 		std::unique_ptr< Impl > pImpl;
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Camera.hpp"
+#include "PointBatch.hpp"
+
+#include "Capture/ACapture.hpp"
+#include "PointDetector/APointDetector.hpp"
+#include "Unprojector/AUnprojector.hpp"
+
+#include <PointIR/Frame.h>
+
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+
+class Camera::Impl
+{
+public:
+	Impl( Camera & camera ) : camera(camera) {}
+
+	// the newest points - replaced by each frame
+	mutable std::mutex mutex;
+	PointIR::PointArray pointArray;
+	std::vector< PointIR::Blob > blobs;
+	uint64_t timestamp = 0;
+	bool hasPoints = false;
+
+	std::atomic< bool > stop { false };
+	std::thread worker;
+
+	void run();
+
+private:
+	Camera & camera;
+};
+
+
+void Camera::Impl::run()
+{
+	PointIR::Frame frame;
+	PointIR::PointArray pointArray;
+	std::vector< PointIR::Blob > blobs;
+	PointBatch unprojectBatch;
+	while( !this->stop )
+	{
+		try
+		{
+			// don't block forever to notice when the camera is stopped
+			if( !this->camera.capture.advanceFrame( true, 0.1f ) )
+				continue;
+			uint64_t timestamp = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+			if( !this->camera.capture.retrieveFrame( frame ) )
+			{
+				std::cerr << "Camera: Could not retrieve frame.\n";
+				std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+				continue;
+			}
+
+			this->camera.detector.detect( pointArray, blobs, frame );
+			this->camera.unprojector.unproject( pointArray, blobs, unprojectBatch );
+
+			// the next frame is detected into the buffers of the replaced points
+			std::lock_guard< std::mutex > lock( this->mutex );
+			this->pointArray.swap( pointArray );
+			this->blobs.swap( blobs );
+			this->timestamp = timestamp;
+			this->hasPoints = true;
+		}
+		catch( std::exception & ex )
+		{
+			std::cerr << std::string(__PRETTY_FUNCTION__) << std::string(": ignoring exception: ") << ex.what() << "\n";
+			std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+		}
+	}
+}
+
+
+Camera::Camera( Capture::ACapture & capture, PointDetector::APointDetector & detector, Unprojector::AUnprojector & unprojector ) :
+	pImpl( new Impl( *this ) ),
+	capture(capture),
+	detector(detector),
+	unprojector(unprojector)
+{
+}
+
+
+Camera::~Camera()
+{
+	this->stop();
+}
+
+
+void Camera::start()
+{
+	if( this->isStarted() )
+		return;
+
+	this->capture.start();
+	this->pImpl->stop = false;
+	this->pImpl->worker = std::thread( &Impl::run, this->pImpl.get() );
+}
+
+
+void Camera::stop()
+{
+	if( !this->isStarted() )
+		return;
+
+	this->pImpl->stop = true;
+	this->pImpl->worker.join();
+	this->capture.stop();
+
+	std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+	this->pImpl->hasPoints = false;
+}
+
+
+bool Camera::isStarted() const
+{
+	return this->pImpl->worker.joinable();
+}
+
+
+bool Camera::retrievePoints( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, uint64_t & timestamp ) const
+{
+	std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+	if( !this->pImpl->hasPoints )
+		return false;
+	pointArray = this->pImpl->pointArray;
+	blobs = this->pImpl->blobs;
+	timestamp = this->pImpl->timestamp;
+	return true;
+}
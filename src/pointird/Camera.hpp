@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CAMERA__INCLUDED_
+#define _CAMERA__INCLUDED_
+
+
+#include <PointIR/PointArray.h>
+#include <PointIR/Blob.h>
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+
+namespace Capture
+{
+	class ACapture;
+}
+
+namespace PointDetector
+{
+	class APointDetector;
+}
+
+namespace Unprojector
+{
+	class AUnprojector;
+}
+
+
+/**
+ * An additional camera of the processor.
+ *
+ * Captures, detects and unprojects on its own thread - the processor merges the newest points of each camera with
+ * the ones of its own capture. The modules are only used by the camera's thread while it is started.
+ */
+class Camera
+{
+public:
+	Camera( const Camera & ) = delete; // disable copy constructor
+	Camera & operator=( const Camera & other ) = delete; // disable assignment operator
+
+	Camera( Capture::ACapture & capture, PointDetector::APointDetector & detector, Unprojector::AUnprojector & unprojector );
+	~Camera();
+
+	Capture::ACapture & getCapture() const { return this->capture; }
+	PointDetector::APointDetector & getPointDetector() const { return this->detector; }
+	Unprojector::AUnprojector & getUnprojector() const { return this->unprojector; }
+
+	void start();
+	void stop();
+	bool isStarted() const;
+
+	/// Copies the newest unprojected points and the time their frame was retrieved (microseconds of a monotonic clock, like Processor::getFrameTimestamp).
+	/// Returns false if there are none yet.
+	bool retrievePoints( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, uint64_t & timestamp ) const;
+
+private:
+	class Impl;
+	std::unique_ptr< Impl > pImpl;
+
+	Capture::ACapture & capture;
+	PointDetector::APointDetector & detector;
+	Unprojector::AUnprojector & unprojector;
+};
+
+
+#endif
@@ -38,6 +38,17 @@ namespace Capture
 class ACapture
 {
 public:
+	/// A part of the full camera image in normalized coordinates.
+	struct Region
+	{
+		float x = 0.0f;
+		float y = 0.0f;
+		float width = 1.0f;
+		float height = 1.0f;
+
+		bool isFull() const { return x <= 0.0f && y <= 0.0f && width >= 1.0f && height >= 1.0f; }
+	};
+
 	virtual ~ACapture() {}
 
 	virtual void start() = 0;
@@ -46,6 +57,12 @@ public:
 	virtual void stop() = 0;
 
 	virtual bool isCapturing() const = 0;
+
+	/// Restricts the retrieved frames to a region of the full camera image - the actual region may be slightly larger
+	/// to meet alignment constraints. A full region restores the whole image. Returns false if the capture can't crop.
+	virtual bool setRegion( const Region & region ) { return region.isFull(); }
+	/// The region of the full camera image shown by the retrieved frames.
+	virtual Region getRegion() const { return Region(); }
 };
 
 }
@@ -21,10 +21,17 @@
 #include "../exceptions.hpp"
 
 #include <PointIR/Frame.h>
+#include <PointIR/FramePool.h>
 
 #include <iostream>
 #include <vector>
 #include <limits>
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 #include <stdint.h>
 #include <string.h>
@@ -39,6 +46,9 @@
 #include <linux/videodev2.h>
 #include <malloc.h>
 
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
 
 using namespace Capture;
 
@@ -113,9 +123,44 @@ public:
 	int fd = 0;
 	std::vector<Buffer> buffers;
 	unsigned int minBufferCount = 2;
-	int currentBuffer = -1;
+	unsigned int requestedBufferCount = 4;
+	int currentBuffer = -1; // dequeued until the next frame is advanced to, so it isn't overwritten while being retrieved
+	unsigned int bytesUsed = 0;
 	unsigned int bytesPerLine = 0;
+	uint32_t pixelFormat = 0;
+	struct v4l2_fract timePerFrame = {};
 	struct v4l2_capability caps = {};
+
+	// size of the full camera image and of the image delivered by the driver - differs if the driver crops
+	unsigned int sensorWidth = 0;
+	unsigned int sensorHeight = 0;
+	unsigned int imageWidth = 0;
+	unsigned int imageHeight = 0;
+	// crop rectangle of the driver covering the full image, if it can crop without scaling
+	bool canCrop = false;
+	struct v4l2_rect defaultCrop = {};
+	bool hardwareCrop = false;
+	// offset of the retrieved region in the delivered image if cropped in software
+	unsigned int cropX = 0;
+	unsigned int cropY = 0;
+	ACapture::Region region;
+
+	// MJPEG frames are decoded on a worker thread while the previous frame is processed - only the luma plane is decoded
+	std::thread decoder;
+	std::mutex mutex;
+	std::condition_variable condition;
+	PointIR::FramePool pool;
+	PointIR::FramePool::Handle decodedFrame;
+	bool stopDecoder = false;
+
+	void setImageFormat( unsigned int width, unsigned int height, const std::string & device );
+	bool setCropRect( const struct v4l2_rect & rect );
+	void mapBuffers( const std::string & device );
+	void unmapBuffers( const std::string & device );
+	bool waitForBuffer( float timeoutSeconds );
+	int dequeueBuffer( const std::string & device );
+	void queueBuffer( int index, const std::string & device );
+	void decode( const std::string & device );
 };
 
 
@@ -129,6 +174,12 @@ static int xioctl( int fd, unsigned long int request, void * arg )
 }
 
 
+static float toSeconds( const struct v4l2_fract & fract )
+{
+	return static_cast<float>(fract.numerator) / static_cast<float>(fract.denominator);
+}
+
+
 static bool getClosestFrameInterval( int fd, float fps, const struct v4l2_pix_format * format, struct v4l2_fract * intervalFract )
 {
 	struct v4l2_frmivalenum ivalenum = {};
@@ -136,44 +187,63 @@ static bool getClosestFrameInterval( int fd, float fps, const struct v4l2_pix_fo
 	ivalenum.pixel_format = format->pixelformat;
 	ivalenum.width = format->width;
 	ivalenum.height = format->height;
+	float thisIval = 1.0f/fps;
 	float selectedFractError = std::numeric_limits< float >::max();
+	auto consider = [&] ( const struct v4l2_fract & fract )
+	{
+		if( !fract.denominator )
+			return;
+		float error = fabs( toSeconds( fract ) - thisIval );
+		if( error < selectedFractError )
+		{
+			*intervalFract = fract;
+			selectedFractError = error;
+		}
+	};
 	while( -1 != xioctl( fd, VIDIOC_ENUM_FRAMEINTERVALS, &ivalenum ) )
 	{
 		switch( ivalenum.type )
 		{
 		case V4L2_FRMIVAL_TYPE_DISCRETE:
+			consider( ivalenum.discrete );
+			break;
+		case V4L2_FRMIVAL_TYPE_STEPWISE:
 			{
-				float ival = static_cast<float>(ivalenum.discrete.numerator) / static_cast<float>(ivalenum.discrete.denominator);
-				float error = fabs( ival - 1.0f/fps );
-				if( error < selectedFractError )
+				// the interval closest to the desired one on the grid min + n * step
+				const struct v4l2_fract & min = ivalenum.stepwise.min;
+				const struct v4l2_fract & max = ivalenum.stepwise.max;
+				const struct v4l2_fract & step = ivalenum.stepwise.step;
+				if( !min.denominator || !max.denominator || !step.denominator || !step.numerator )
+					break;
+				float steps = roundf( ( std::min( std::max( thisIval, toSeconds( min ) ), toSeconds( max ) ) - toSeconds( min ) ) / toSeconds( step ) );
+				uint64_t numerator = (uint64_t)min.numerator * step.denominator + (uint64_t)steps * step.numerator * min.denominator;
+				uint64_t denominator = (uint64_t)min.denominator * step.denominator;
+				while( numerator > std::numeric_limits< uint32_t >::max() || denominator > std::numeric_limits< uint32_t >::max() )
 				{
-					*intervalFract = ivalenum.discrete;
-					selectedFractError = error;
+					numerator >>= 1;
+					denominator >>= 1;
 				}
+				struct v4l2_fract fract = { (uint32_t)numerator, (uint32_t)denominator };
+				consider( fract );
 			}
 			break;
-		case V4L2_FRMIVAL_TYPE_STEPWISE:
-			//TODO:: implement
-			throw RUNTIME_ERROR( "V4L2_FRMIVAL_TYPE_STEPWISE is unimplemented" );
-			break;
 		case V4L2_FRMIVAL_TYPE_CONTINUOUS:
 			{
-				float ivalMin = static_cast<float>(ivalenum.stepwise.min.numerator) / static_cast<float>(ivalenum.stepwise.min.denominator);
-				float ivalMax = static_cast<float>(ivalenum.stepwise.max.numerator) / static_cast<float>(ivalenum.stepwise.max.denominator);
-				float thisIval = 1.0f/fps;
+				float ivalMin = toSeconds( ivalenum.stepwise.min );
+				float ivalMax = toSeconds( ivalenum.stepwise.max );
 				if( thisIval < ivalMin )
 				{
-					*intervalFract = ivalenum.stepwise.min;
+					consider( ivalenum.stepwise.min );
 				}
 				else if( thisIval > ivalMax )
 				{
-					*intervalFract = ivalenum.stepwise.max;
+					consider( ivalenum.stepwise.max );
 				}
 				else
 				{
-					rat_approx<decltype(intervalFract->denominator)>( thisIval, 1000, &(intervalFract->numerator), &(intervalFract->denominator) );
-					float ival = static_cast<float>(intervalFract->numerator) / static_cast<float>(intervalFract->denominator);
-					selectedFractError = fabs( ival - 1.0f/fps );
+					struct v4l2_fract fract = {};
+					rat_approx<decltype(fract.denominator)>( thisIval, 1000, &(fract.numerator), &(fract.denominator) );
+					consider( fract );
 				}
 			}
 			break;
@@ -184,7 +254,66 @@ static bool getClosestFrameInterval( int fd, float fps, const struct v4l2_pix_fo
 }
 
 
-Video4Linux2::Video4Linux2( const std::string & device, unsigned int width, unsigned int height, float fps )
+static std::string fourccToString( uint32_t fourcc )
+{
+	return std::string( reinterpret_cast< const char * >( &fourcc ), 4 );
+}
+
+
+static uint32_t stringToFourcc( const std::string & name )
+{
+	if( name.size() != 4 )
+		return 0;
+	return v4l2_fourcc( name[0], name[1], name[2], name[3] );
+}
+
+
+// supported pixel formats in order of preference - native greyscale needs the least bandwidth and conversion
+static const uint32_t supportedPixelFormats[] =
+{
+	V4L2_PIX_FMT_GREY,
+	V4L2_PIX_FMT_Y16,
+	V4L2_PIX_FMT_Y10,
+	V4L2_PIX_FMT_YUYV,
+	V4L2_PIX_FMT_MJPEG
+};
+
+
+// the preferred supported format delivering the desired size - or the preferred one at all if none does
+static uint32_t negotiatePixelFormat( int fd, unsigned int width, unsigned int height )
+{
+	std::vector< uint32_t > available;
+	struct v4l2_fmtdesc fmtdesc = {};
+	fmtdesc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	while( 0 == xioctl( fd, VIDIOC_ENUM_FMT, &fmtdesc ) )
+	{
+		available.push_back( fmtdesc.pixelformat );
+		fmtdesc.index++;
+	}
+
+	uint32_t fallback = 0;
+	for( uint32_t pixelFormat : supportedPixelFormats )
+	{
+		if( std::find( available.begin(), available.end(), pixelFormat ) == available.end() )
+			continue;
+		struct v4l2_format fmt = {};
+		fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		fmt.fmt.pix.width       = width;
+		fmt.fmt.pix.height      = height;
+		fmt.fmt.pix.pixelformat = pixelFormat;
+		fmt.fmt.pix.field       = V4L2_FIELD_ANY;
+		if( -1 == xioctl( fd, VIDIOC_TRY_FMT, &fmt ) || fmt.fmt.pix.pixelformat != pixelFormat )
+			continue;
+		if( fmt.fmt.pix.width == width && fmt.fmt.pix.height == height )
+			return pixelFormat;
+		if( !fallback )
+			fallback = pixelFormat;
+	}
+	return fallback;
+}
+
+
+Video4Linux2::Video4Linux2( const std::string & device, unsigned int width, unsigned int height, float fps, const std::string & pixelFormat )
 	: pImpl( new Impl ), device(device), width(width), height(height), fps(fps)
 {
 	// check if device exists
@@ -210,38 +339,32 @@ Video4Linux2::Video4Linux2( const std::string & device, unsigned int width, unsi
 
 	if( !this->canStream() )
 		throw RUNTIME_ERROR( "\"" + this->device + "\" cannot stream" );
-/*
-	struct v4l2_cropcap cropcap = {};
-	cropcap.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-	if( 0 == xioctl( this->pImpl->fd, VIDIOC_CROPCAP, &cropcap ) )
+	// select the pixel format
+	if( pixelFormat.empty() )
 	{
-		struct v4l2_crop crop = {};
-		crop.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-		crop.c = cropcap.defrect; // reset to default
-		if( -1 == xioctl( this->pImpl->fd, VIDIOC_S_CROP, &crop ) )
-		{
-			switch( errno )
-			{
-			case EINVAL:
-				break; // Cropping not supported.
-			default:
-				break; // Errors ignored.
-			}
-		}
+		this->pImpl->pixelFormat = negotiatePixelFormat( this->pImpl->fd, this->width, this->height );
+		if( !this->pImpl->pixelFormat )
+			throw RUNTIME_ERROR( "\"" + this->device + "\" supports none of the pixel formats GREY, Y16, Y10, YUYV or MJPG" );
 	}
-*/
+	else
+	{
+		this->pImpl->pixelFormat = stringToFourcc( pixelFormat );
+		if( std::find( std::begin( supportedPixelFormats ), std::end( supportedPixelFormats ), this->pImpl->pixelFormat ) == std::end( supportedPixelFormats ) )
+			throw RUNTIME_ERROR( "pixel format \"" + pixelFormat + "\" is not supported - use GREY, Y16, Y10, YUYV or MJPG" );
+	}
+
 	// try to set desired format - warn if driver changes format
 	struct v4l2_format fmt = {};
 	fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 	fmt.fmt.pix.width       = this->width;
 	fmt.fmt.pix.height      = this->height;
-	fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
+	fmt.fmt.pix.pixelformat = this->pImpl->pixelFormat;
 	fmt.fmt.pix.field       = V4L2_FIELD_ANY;
 	if( -1 == xioctl( this->pImpl->fd, VIDIOC_S_FMT, &fmt ) )
 		throw SYSTEM_ERROR( errno, "ioctl(\"" + this->device + "\",VIDIOC_S_FMT)" );
 
-	if( fmt.fmt.pix.pixelformat != V4L2_PIX_FMT_YUYV )
-		throw RUNTIME_ERROR( "\"" + this->device + "\" does not support YUYV pixel format" );
+	if( fmt.fmt.pix.pixelformat != this->pImpl->pixelFormat )
+		throw RUNTIME_ERROR( "\"" + this->device + "\" does not support " + fourccToString( this->pImpl->pixelFormat ) + " pixel format" );
 
 	if( this->width != fmt.fmt.pix.width || this->height != fmt.fmt.pix.height )
 	{
@@ -252,6 +375,17 @@ Video4Linux2::Video4Linux2( const std::string & device, unsigned int width, unsi
 	this->width = fmt.fmt.pix.width;
 	this->height = fmt.fmt.pix.height;
 	this->pImpl->bytesPerLine = fmt.fmt.pix.bytesperline;
+	this->pImpl->sensorWidth = this->pImpl->imageWidth = this->width;
+	this->pImpl->sensorHeight = this->pImpl->imageHeight = this->height;
+
+	// the driver may crop to a region of interest if its default crop rectangle isn't scaled to the image
+	struct v4l2_cropcap cropcap = {};
+	cropcap.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	if( 0 == xioctl( this->pImpl->fd, VIDIOC_CROPCAP, &cropcap ) )
+	{
+		this->pImpl->defaultCrop = cropcap.defrect;
+		this->pImpl->canCrop = cropcap.defrect.width == this->width && cropcap.defrect.height == this->height;
+	}
 
 	// find and set closest frame interval if possible
 	struct v4l2_streamparm streamParm = {};
@@ -261,44 +395,17 @@ Video4Linux2::Video4Linux2( const std::string & device, unsigned int width, unsi
 	{
 		if( -1 == xioctl( this->pImpl->fd, VIDIOC_S_PARM, &streamParm ) )
 			throw SYSTEM_ERROR( errno, "ioctl(\"" + this->device + "\",VIDIOC_S_PARM)" );
+		this->pImpl->timePerFrame = streamParm.parm.capture.timeperframe;
 	}
 	else
 	{
 		std::cerr << "Capture::Video4Linux2: \"" << this->device << "\": " << "Could not find any supported frame interval setting\n";
 	}
 
-		std::cout << "Capture::Video4Linux2: \"" << this->device << "\": " << "Selected format " << this->width << "x" << this->height
+		std::cout << "Capture::Video4Linux2: \"" << this->device << "\": " << "Selected format " << fourccToString( this->pImpl->pixelFormat ) << " " << this->width << "x" << this->height
 		<< " @ " << streamParm.parm.capture.timeperframe.numerator << "/" << streamParm.parm.capture.timeperframe.denominator << " s frame interval\n";
 
-	// setup memory mapped stream
-	struct v4l2_requestbuffers req = {};
-	req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-	req.memory = V4L2_MEMORY_MMAP;
-	req.count  = this->pImpl->minBufferCount;
-	if( -1 == xioctl( this->pImpl->fd, VIDIOC_REQBUFS, &req ) )
-		throw SYSTEM_ERROR( errno, "ioctl(\"" + this->device + "\",VIDIOC_REQBUFS)" );
-
-	if( req.count < this->pImpl->minBufferCount )
-		throw RUNTIME_ERROR( "\"" + this->device + "\": Could not acquire required buffers - requested "
-			+ std::to_string(this->pImpl->minBufferCount) + " got " + std::to_string(req.count) );
-
-	for( size_t i = 0; i < req.count; ++i )
-	{
-		struct v4l2_buffer buf = {};
-		buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-		buf.memory = V4L2_MEMORY_MMAP;
-		buf.index  = i;
-		if( -1 == xioctl( this->pImpl->fd, VIDIOC_QUERYBUF, &buf ) )
-			throw SYSTEM_ERROR( errno, "ioctl(\"" + this->device + "\",VIDIOC_QUERYBUF)" );
-
-		Impl::Buffer newBuffer;
-		newBuffer.length = buf.length;
-		newBuffer.start = mmap( NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, this->pImpl->fd, buf.m.offset );
-		if( MAP_FAILED == newBuffer.start )
-			throw SYSTEM_ERROR( errno, "mmap( NULL, " + std::to_string(buf.length)
-				+ ", PROT_READ | PROT_WRITE, MAP_SHARED, \"" + this->device + "\", " + std::to_string(buf.m.offset) );
-		this->pImpl->buffers.push_back( newBuffer );
-	}
+	this->pImpl->mapBuffers( this->device );
 }
 
 
@@ -306,11 +413,10 @@ Video4Linux2::~Video4Linux2()
 {
 	try
 	{
-		for( Impl::Buffer & buffer : this->pImpl->buffers )
-		{
-			if( -1 == munmap( buffer.start, buffer.length ) )
-				throw SYSTEM_ERROR( errno, "munmap" );
-		}
+		if( this->capturing )
+			this->stop();
+
+		this->pImpl->unmapBuffers( this->device );
 
 		if( this->pImpl->fd )
 		{
@@ -346,92 +452,316 @@ void Video4Linux2::start()
 	if( -1 == xioctl( this->pImpl->fd, VIDIOC_STREAMON, &type ) )
 		throw SYSTEM_ERROR( errno, "ioctl(\"" + this->device + "\",VIDIOC_STREAMON)" );
 
+	if( V4L2_PIX_FMT_MJPEG == this->pImpl->pixelFormat )
+	{
+		this->pImpl->stopDecoder = false;
+		this->pImpl->decodedFrame.reset();
+		this->pImpl->decoder = std::thread( &Impl::decode, this->pImpl.get(), this->device );
+	}
+
 	this->capturing = true;
 }
 
 
 void Video4Linux2::stop()
 {
+	if( this->pImpl->decoder.joinable() )
+	{
+		{
+			std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+			this->pImpl->stopDecoder = true;
+		}
+		this->pImpl->decoder.join();
+	}
+
 	enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 	if( -1 == xioctl( this->pImpl->fd, VIDIOC_STREAMOFF, &type ) )
 		throw SYSTEM_ERROR( errno, "ioctl(\"" + this->device + "\",VIDIOC_STREAMOFF)" );
 
+	// streaming off dequeues all buffers
+	this->pImpl->currentBuffer = -1;
 	this->capturing = false;
 }
 
 
-bool Video4Linux2::advanceFrame( bool block, float timeoutSeconds )
+void Video4Linux2::Impl::setImageFormat( unsigned int width, unsigned int height, const std::string & device )
 {
-	if( block )
+	struct v4l2_format fmt = {};
+	fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	fmt.fmt.pix.width       = width;
+	fmt.fmt.pix.height      = height;
+	fmt.fmt.pix.pixelformat = this->pixelFormat;
+	fmt.fmt.pix.field       = V4L2_FIELD_ANY;
+	if( -1 == xioctl( this->fd, VIDIOC_S_FMT, &fmt ) )
+		throw SYSTEM_ERROR( errno, "ioctl(\"" + device + "\",VIDIOC_S_FMT)" );
+	this->imageWidth = fmt.fmt.pix.width;
+	this->imageHeight = fmt.fmt.pix.height;
+	this->bytesPerLine = fmt.fmt.pix.bytesperline;
+
+	// some drivers reset the frame interval with the format
+	if( this->timePerFrame.denominator )
 	{
-		while( true )
-		{
-			fd_set fds;
-			struct timeval tv;
-			int r;
+		struct v4l2_streamparm streamParm = {};
+		streamParm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		streamParm.parm.capture.timeperframe = this->timePerFrame;
+		xioctl( this->fd, VIDIOC_S_PARM, &streamParm );
+	}
+}
 
-			FD_ZERO( &fds );
-			FD_SET( this->pImpl->fd, &fds );
 
-			if( timeoutSeconds <= 0.0f )
-			{
-				r = select( this->pImpl->fd + 1, &fds, NULL, NULL, NULL );
-			}
-			else
-			{
-				tv.tv_sec = timeoutSeconds;
-				tv.tv_usec = (timeoutSeconds-(int)timeoutSeconds)/1000000.0f;
-				r = select( this->pImpl->fd + 1, &fds, NULL, NULL, &tv );
-			}
+// returns whether the driver crops to exactly the given rectangle now
+bool Video4Linux2::Impl::setCropRect( const struct v4l2_rect & rect )
+{
+	struct v4l2_selection selection = {};
+	selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	selection.target = V4L2_SEL_TGT_CROP;
+	selection.r = rect;
+	if( 0 == xioctl( this->fd, VIDIOC_S_SELECTION, &selection ) )
+		return selection.r.left == rect.left && selection.r.top == rect.top && selection.r.width == rect.width && selection.r.height == rect.height;
+
+	// older drivers only know the crop interface
+	struct v4l2_crop crop = {};
+	crop.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	crop.c = rect;
+	if( -1 == xioctl( this->fd, VIDIOC_S_CROP, &crop ) )
+		return false;
+	if( -1 == xioctl( this->fd, VIDIOC_G_CROP, &crop ) )
+		return false;
+	return crop.c.left == rect.left && crop.c.top == rect.top && crop.c.width == rect.width && crop.c.height == rect.height;
+}
 
-			if( -1 == r )
-			{
-				if( EINTR == errno )
-					continue;
-				throw SYSTEM_ERROR( errno, "select" );
-			}
 
-			if( 0 == r )
-			{
-				std::cerr << "Capture::Video4Linux2: \"" << "\"" << this->device << "\": " << "timed out\n";
-				return false;
-			}
-			break;
+void Video4Linux2::Impl::mapBuffers( const std::string & device )
+{
+	// setup memory mapped stream
+	struct v4l2_requestbuffers req = {};
+	req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	req.memory = V4L2_MEMORY_MMAP;
+	req.count  = this->requestedBufferCount;
+	if( -1 == xioctl( this->fd, VIDIOC_REQBUFS, &req ) )
+		throw SYSTEM_ERROR( errno, "ioctl(\"" + device + "\",VIDIOC_REQBUFS)" );
+
+	if( req.count < this->minBufferCount )
+		throw RUNTIME_ERROR( "\"" + device + "\": Could not acquire required buffers - requested "
+			+ std::to_string(this->minBufferCount) + " got " + std::to_string(req.count) );
+
+	for( size_t i = 0; i < req.count; ++i )
+	{
+		struct v4l2_buffer buf = {};
+		buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+		buf.memory = V4L2_MEMORY_MMAP;
+		buf.index  = i;
+		if( -1 == xioctl( this->fd, VIDIOC_QUERYBUF, &buf ) )
+			throw SYSTEM_ERROR( errno, "ioctl(\"" + device + "\",VIDIOC_QUERYBUF)" );
+
+		Impl::Buffer newBuffer;
+		newBuffer.length = buf.length;
+		newBuffer.start = mmap( NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, buf.m.offset );
+		if( MAP_FAILED == newBuffer.start )
+			throw SYSTEM_ERROR( errno, "mmap( NULL, " + std::to_string(buf.length)
+				+ ", PROT_READ | PROT_WRITE, MAP_SHARED, \"" + device + "\", " + std::to_string(buf.m.offset) );
+		this->buffers.push_back( newBuffer );
+	}
+}
+
+
+void Video4Linux2::Impl::unmapBuffers( const std::string & device )
+{
+	for( Impl::Buffer & buffer : this->buffers )
+	{
+		if( -1 == munmap( buffer.start, buffer.length ) )
+			throw SYSTEM_ERROR( errno, "munmap" );
+	}
+	this->buffers.clear();
+
+	// release the buffers so the format may be changed
+	struct v4l2_requestbuffers req = {};
+	req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	req.memory = V4L2_MEMORY_MMAP;
+	req.count  = 0;
+	if( -1 == xioctl( this->fd, VIDIOC_REQBUFS, &req ) )
+		throw SYSTEM_ERROR( errno, "ioctl(\"" + device + "\",VIDIOC_REQBUFS)" );
+}
+
+
+bool Video4Linux2::Impl::waitForBuffer( float timeoutSeconds )
+{
+	while( true )
+	{
+		fd_set fds;
+		struct timeval tv;
+		int r;
+
+		FD_ZERO( &fds );
+		FD_SET( this->fd, &fds );
+
+		if( timeoutSeconds <= 0.0f )
+		{
+			r = select( this->fd + 1, &fds, NULL, NULL, NULL );
+		}
+		else
+		{
+			tv.tv_sec = timeoutSeconds;
+			tv.tv_usec = (timeoutSeconds-(int)timeoutSeconds)*1000000.0f;
+			r = select( this->fd + 1, &fds, NULL, NULL, &tv );
 		}
+
+		if( -1 == r )
+		{
+			if( EINTR == errno )
+				continue;
+			throw SYSTEM_ERROR( errno, "select" );
+		}
+
+		return 0 != r;
 	}
+}
+
 
+int Video4Linux2::Impl::dequeueBuffer( const std::string & device )
+{
 	struct v4l2_buffer buf = {0};
 	buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 	buf.memory = V4L2_MEMORY_MMAP;
 
-	if( -1 == xioctl( this->pImpl->fd, VIDIOC_DQBUF, &buf ) )
+	if( -1 == xioctl( this->fd, VIDIOC_DQBUF, &buf ) )
 	{
 		switch( errno )
 		{
 		case EAGAIN:
-			return false;
+			return -1;
 		case EIO:
 			// Could ignore EIO, see spec.
 			// fall through
 		default:
-			throw SYSTEM_ERROR( errno, "ioctl(\"" + this->device + "\",VIDIOC_DQBUF)" );
+			throw SYSTEM_ERROR( errno, "ioctl(\"" + device + "\",VIDIOC_DQBUF)" );
 		}
 	}
 
-	if( buf.index >= this->pImpl->buffers.size() )
-		throw RUNTIME_ERROR( "\"" + this->device + "\" returned buffer index out of range - expected maximum "
-			+ std::to_string(this->pImpl->buffers.size()) + " but got " + std::to_string(buf.index) );
+	if( buf.index >= this->buffers.size() )
+		throw RUNTIME_ERROR( "\"" + device + "\" returned buffer index out of range - expected maximum "
+			+ std::to_string(this->buffers.size()) + " but got " + std::to_string(buf.index) );
+
+	this->bytesUsed = buf.bytesused;
+	return buf.index;
+}
 
-	if( -1 == xioctl( pImpl->fd, VIDIOC_QBUF, &buf ) )
-		throw SYSTEM_ERROR( errno, "ioctl(\"" + this->device + "\",VIDIOC_QBUF)" );
 
-	this->pImpl->currentBuffer = buf.index;
-	return true;
+void Video4Linux2::Impl::queueBuffer( int index, const std::string & device )
+{
+	struct v4l2_buffer buf = {0};
+	buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	buf.memory = V4L2_MEMORY_MMAP;
+	buf.index  = index;
+	if( -1 == xioctl( this->fd, VIDIOC_QBUF, &buf ) )
+		throw SYSTEM_ERROR( errno, "ioctl(\"" + device + "\",VIDIOC_QBUF)" );
+}
+
+
+void Video4Linux2::Impl::decode( const std::string & device )
+{
+	cv::Mat decoded;
+	while( true )
+	{
+		{
+			std::lock_guard< std::mutex > lock( this->mutex );
+			if( this->stopDecoder )
+				return;
+		}
+
+		try
+		{
+			if( !this->waitForBuffer( 0.1f ) )
+				continue;
+			int index = this->dequeueBuffer( device );
+			if( index < 0 )
+				continue;
+			cv::Mat encoded( 1, this->bytesUsed, CV_8UC1, this->buffers[index].start );
+			cv::imdecode( encoded, cv::IMREAD_GRAYSCALE, &decoded );
+			this->queueBuffer( index, device );
+			if( decoded.empty() || CV_8UC1 != decoded.type() )
+			{
+				std::cerr << "Capture::Video4Linux2: \"" << device << "\": " << "could not decode MJPEG frame\n";
+				continue;
+			}
+
+			// only the retrieved region if cropped in software
+			unsigned int x = std::min< unsigned int >( this->cropX, decoded.cols );
+			unsigned int y = std::min< unsigned int >( this->cropY, decoded.rows );
+			unsigned int width = std::min< unsigned int >( decoded.cols - x, this->region.width * this->sensorWidth + 0.5f );
+			unsigned int height = std::min< unsigned int >( decoded.rows - y, this->region.height * this->sensorHeight + 0.5f );
+			PointIR::FramePool::Handle frame = this->pool.acquire( width, height );
+			for( unsigned int row = 0; row < height; row++ )
+				memcpy( frame->getRow( row ), decoded.ptr( y + row ) + x, width );
+
+			{
+				std::lock_guard< std::mutex > lock( this->mutex );
+				// an unretrieved frame goes back to the pool
+				std::swap( this->decodedFrame, frame );
+			}
+			this->condition.notify_one();
+		}
+		catch( std::exception & ex )
+		{
+			std::cerr << std::string(__PRETTY_FUNCTION__) << std::string(": ignoring exception: ") << ex.what() << "\n";
+			std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+		}
+	}
+}
+
+
+bool Video4Linux2::advanceFrame( bool block, float timeoutSeconds )
+{
+	if( V4L2_PIX_FMT_MJPEG == this->pImpl->pixelFormat )
+	{
+		std::unique_lock< std::mutex > lock( this->pImpl->mutex );
+		if( block )
+		{
+			auto decoded = [this] { return bool( this->pImpl->decodedFrame ); };
+			if( timeoutSeconds <= 0.0f )
+				this->pImpl->condition.wait( lock, decoded );
+			else if( !this->pImpl->condition.wait_for( lock, std::chrono::duration< float >( timeoutSeconds ), decoded ) )
+			{
+				std::cerr << "Capture::Video4Linux2: \"" << this->device << "\": " << "timed out\n";
+				return false;
+			}
+		}
+		return bool( this->pImpl->decodedFrame );
+	}
+
+	if( block && !this->pImpl->waitForBuffer( timeoutSeconds ) )
+	{
+		std::cerr << "Capture::Video4Linux2: \"" << this->device << "\": " << "timed out\n";
+		return false;
+	}
+
+	// hand the previously retrieved buffer back to the driver
+	if( this->pImpl->currentBuffer >= 0 )
+	{
+		this->pImpl->queueBuffer( this->pImpl->currentBuffer, this->device );
+		this->pImpl->currentBuffer = -1;
+	}
+
+	this->pImpl->currentBuffer = this->pImpl->dequeueBuffer( this->device );
+	return this->pImpl->currentBuffer >= 0;
 }
 
 
 bool Video4Linux2::retrieveFrame( PointIR::Frame & frame ) const
 {
+	if( V4L2_PIX_FMT_MJPEG == this->pImpl->pixelFormat )
+	{
+		std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+		if( !this->pImpl->decodedFrame )
+		{
+			std::cerr << "Capture::Video4Linux2: no frame decoded\n";
+			return false;
+		}
+		frame = *(this->pImpl->decodedFrame);
+		this->pImpl->decodedFrame.reset();
+		return true;
+	}
+
 	if( this->pImpl->currentBuffer < 0 )
 	{
 		std::cerr << "Capture::Video4Linux2: no buffer available\n";
@@ -440,24 +770,141 @@ bool Video4Linux2::retrieveFrame( PointIR::Frame & frame ) const
 
 	frame.resize( this->width, this->height );
 
-	uint8_t * src = static_cast<uint8_t*>( this->pImpl->buffers[this->pImpl->currentBuffer].start );
+	const uint8_t * src = static_cast<const uint8_t*>( this->pImpl->buffers[this->pImpl->currentBuffer].start );
 	uint8_t * dst = frame.getData();
+	unsigned int bytesPerLine = this->pImpl->bytesPerLine;
 
-	// copy greyscale component to destination buffer
-	for( unsigned int h = 0; h < this->height; h++ )
+	// skip to the region if cropped in software
+	unsigned int bytesPerPixel = ( V4L2_PIX_FMT_GREY == this->pImpl->pixelFormat ) ? 1 : 2;
+	src += this->pImpl->cropY * bytesPerLine + this->pImpl->cropX * bytesPerPixel;
+
+	switch( this->pImpl->pixelFormat )
 	{
-		for( unsigned int i = 0; i < this->width-1; i += 2 )
+	case V4L2_PIX_FMT_GREY:
+		// already in the frame's format - copy as a whole if the lines aren't padded
+		if( bytesPerLine == this->width )
 		{
-			*dst++ = src[0];
-			*dst++ = src[2];
-			src += 4;
+			memcpy( dst, src, this->width * this->height );
+			break;
 		}
-		src += this->pImpl->bytesPerLine - ( this->width * 2 );
+		for( unsigned int h = 0; h < this->height; h++ )
+			memcpy( dst + h * this->width, src + h * bytesPerLine, this->width );
+		break;
+	case V4L2_PIX_FMT_Y16:
+	case V4L2_PIX_FMT_Y10:
+		{
+			// little endian 16 bit words - keep the most significant 8 bits
+			unsigned int shift = ( V4L2_PIX_FMT_Y16 == this->pImpl->pixelFormat ) ? 8 : 2;
+			for( unsigned int h = 0; h < this->height; h++ )
+			{
+				const uint8_t * line = src + h * bytesPerLine;
+				for( unsigned int w = 0; w < this->width; w++ )
+					*dst++ = std::min( 0xff, ( line[2*w] | ( line[2*w+1] << 8 ) ) >> shift );
+			}
+		}
+		break;
+	case V4L2_PIX_FMT_YUYV:
+		// copy greyscale component to destination buffer
+		for( unsigned int h = 0; h < this->height; h++ )
+		{
+			for( unsigned int i = 0; i < this->width-1; i += 2 )
+			{
+				*dst++ = src[0];
+				*dst++ = src[2];
+				src += 4;
+			}
+			src += bytesPerLine - ( this->width * 2 );
+		}
+		break;
+	}
+	return true;
+}
+
+
+bool Video4Linux2::setRegion( const Region & region )
+{
+	// pixel rectangle in the full image - horizontally aligned to the two pixel macro pixels of YUYV
+	unsigned int sensorWidth = this->pImpl->sensorWidth;
+	unsigned int sensorHeight = this->pImpl->sensorHeight;
+	unsigned int left = std::max( 0.0f, std::floor( region.x * sensorWidth ) );
+	unsigned int top = std::max( 0.0f, std::floor( region.y * sensorHeight ) );
+	unsigned int right = std::max( 0.0f, std::ceil( ( region.x + region.width ) * sensorWidth ) );
+	unsigned int bottom = std::max( 0.0f, std::ceil( ( region.y + region.height ) * sensorHeight ) );
+	left = std::min( left & ~1u, sensorWidth );
+	top = std::min( top, sensorHeight );
+	right = std::min( ( right + 1 ) & ~1u, sensorWidth );
+	bottom = std::min( bottom, sensorHeight );
+	if( right <= left || bottom <= top )
+		return false;
+	bool full = !left && !top && right == sensorWidth && bottom == sensorHeight;
+
+	// the driver's image only changes with hardware cropping - decoded MJPEG frames are already cropped
+	bool wasCapturing = this->capturing;
+	bool changeImage = this->pImpl->hardwareCrop || ( !full && this->pImpl->canCrop );
+	if( wasCapturing && ( changeImage || V4L2_PIX_FMT_MJPEG == this->pImpl->pixelFormat ) )
+		this->stop();
+
+	if( changeImage )
+	{
+		this->pImpl->unmapBuffers( this->device );
+		bool hardwareCrop = false;
+		if( !full && this->pImpl->canCrop )
+		{
+			struct v4l2_rect rect = this->pImpl->defaultCrop;
+			rect.left += left;
+			rect.top += top;
+			rect.width = right - left;
+			rect.height = bottom - top;
+			if( this->pImpl->setCropRect( rect ) )
+			{
+				this->pImpl->setImageFormat( rect.width, rect.height, this->device );
+				hardwareCrop = this->pImpl->imageWidth == rect.width && this->pImpl->imageHeight == rect.height;
+			}
+			if( !hardwareCrop )
+			{
+				// don't try again - crop in software from now on
+				this->pImpl->canCrop = false;
+				std::cerr << "Capture::Video4Linux2: \"" << this->device << "\": " << "cropping not supported by the driver - cropping in software\n";
+			}
+		}
+		if( !hardwareCrop )
+		{
+			this->pImpl->setCropRect( this->pImpl->defaultCrop );
+			this->pImpl->setImageFormat( sensorWidth, sensorHeight, this->device );
+			if( this->pImpl->imageWidth != sensorWidth || this->pImpl->imageHeight != sensorHeight )
+				throw RUNTIME_ERROR( "\"" + this->device + "\": could not restore the image size after cropping" );
+		}
+		this->pImpl->hardwareCrop = hardwareCrop;
+		this->pImpl->mapBuffers( this->device );
 	}
+
+	this->pImpl->cropX = this->pImpl->hardwareCrop ? 0 : left;
+	this->pImpl->cropY = this->pImpl->hardwareCrop ? 0 : top;
+	this->width = right - left;
+	this->height = bottom - top;
+	this->pImpl->region.x = (float)left / (float)sensorWidth;
+	this->pImpl->region.y = (float)top / (float)sensorHeight;
+	this->pImpl->region.width = (float)this->width / (float)sensorWidth;
+	this->pImpl->region.height = (float)this->height / (float)sensorHeight;
+
+	if( wasCapturing && !this->capturing )
+		this->start();
 	return true;
 }
 
 
+ACapture::Region Video4Linux2::getRegion() const
+{
+	return this->pImpl->region;
+}
+
+
+std::string Video4Linux2::getPixelFormat() const
+{
+	return fourccToString( this->pImpl->pixelFormat );
+}
+
+
 std::string Video4Linux2::getName() const
 {
 	return std::string( reinterpret_cast< const char * >(this->pImpl->caps.card) );
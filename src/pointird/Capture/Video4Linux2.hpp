@@ -36,7 +36,8 @@ public:
 	Video4Linux2( const Video4Linux2 & ) = delete; // disable copy constructor
 	Video4Linux2 & operator=( const Video4Linux2 & other ) = delete; // disable assignment operator
 
-	Video4Linux2( const std::string & device, unsigned int width = 320, unsigned int height = 240, float fps = 30 );
+	/// The pixel format is given as FourCC (GREY, Y16, Y10, YUYV or MJPG) - if empty, the first of these supported by the device is used.
+	Video4Linux2( const std::string & device, unsigned int width = 320, unsigned int height = 240, float fps = 30, const std::string & pixelFormat = "" );
 	virtual ~Video4Linux2();
 
 	virtual void start() override;
@@ -46,10 +47,16 @@ public:
 
 	virtual bool isCapturing() const override { return this->capturing; };
 
+	/// Lets the driver crop if it can - otherwise only the region is copied from the driver's buffers.
+	virtual bool setRegion( const Region & region ) override;
+	virtual Region getRegion() const override;
+
 	std::string getName() const;
+	/// Size of the retrieved frames - only shows the region if set.
 	unsigned int getWidth() const { return this->width; }
 	unsigned int getHeight() const { return this->height; }
 	std::string getDevice() const { return this->device; }
+	std::string getPixelFormat() const;
 	bool canStream() const;
 	bool canCaptureVideo() const;
 
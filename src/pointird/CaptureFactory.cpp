@@ -46,7 +46,7 @@ CaptureFactory::CaptureFactory() : pImpl( new Impl )
 {
 #ifdef POINTIR_V4L2
 	this->pImpl->captureMap.insert( { "v4l2", [this] ()
-		{ return new Capture::Video4Linux2( this->deviceName, this->width, this->height, this->fps ); }
+		{ return new Capture::Video4Linux2( this->deviceName, this->width, this->height, this->fps, this->pixelFormat ); }
 	} );
 #endif
 	this->pImpl->captureMap.insert( { "cv", [this] ()
@@ -48,6 +48,8 @@ public:
 	unsigned int width = 320;
 	unsigned int height = 240;
 	float fps = 30.0f;
+	/// FourCC of the pixel format requested by the v4l2 capture - empty to negotiate the best one.
+	std::string pixelFormat;
 
 private:
 	class Impl;
@@ -24,7 +24,7 @@
 #include "../Unprojector/AAutoUnprojector.hpp"
 #include "../Unprojector/CalibrationDataFile.hpp"
 #include "../Unprojector/CalibrationImageFile.hpp"
-#include "../PointDetector/OpenCV.hpp"
+#include "../PointDetector/AThresholdDetector.hpp"
 
 #include <iostream>
 #include <string>
@@ -108,13 +108,13 @@ public:
 		this->interfaceMap.insert( { "PointIR.Controller.Unprojector", unprojectorMethods } );
 
 		MethodMap pointDetectorMethods;
-		if( PointDetector::OpenCV * pointDetector = dynamic_cast<PointDetector::OpenCV*>( &(processor.getPointDetector()) ) )
+		if( PointDetector::AThresholdDetector * pointDetector = dynamic_cast<PointDetector::AThresholdDetector*>( &(processor.getPointDetector()) ) )
 		{
 			pointDetectorMethods.insert( { "setIntensityThreshold", std::bind( &Impl::set< unsigned char >, this,
-				Setter< unsigned char >( std::bind( &PointDetector::OpenCV::setIntensityThreshold, pointDetector, _1 ) ),
+				Setter< unsigned char >( std::bind( &PointDetector::AThresholdDetector::setIntensityThreshold, pointDetector, _1 ) ),
 				_1, _2 ) } );
 			pointDetectorMethods.insert( { "getIntensityThreshold", std::bind( &Impl::get< unsigned char >, this,
-				Getter< unsigned char >( std::bind( &PointDetector::OpenCV::getIntensityThreshold, pointDetector ) ),
+				Getter< unsigned char >( std::bind( &PointDetector::AThresholdDetector::getIntensityThreshold, pointDetector ) ),
 				_1, _2 ) } );
 		}
 		this->interfaceMap.insert( { "PointIR.Controller.PointDetector", pointDetectorMethods } );
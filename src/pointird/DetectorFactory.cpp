@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DetectorFactory.hpp"
+
+#include "PointDetector/APointDetector.hpp"
+
+#include "PointDetector/OpenCV.hpp"
+#include "PointDetector/Banded.hpp"
+#include "PointDetector/Brightest.hpp"
+
+#include <string>
+#include <map>
+#include <functional>
+
+
+class DetectorFactory::Impl
+{
+public:
+	typedef std::function< PointDetector::APointDetector*(void) > DetectorCreator;
+	typedef std::map< std::string, DetectorCreator > DetectorMap;
+
+	DetectorMap detectorMap;
+};
+
+
+DetectorFactory::DetectorFactory() : pImpl( new Impl )
+{
+	this->pImpl->detectorMap.insert( { "cv", [this] ()
+		{
+			PointDetector::OpenCV * detector = new PointDetector::OpenCV;
+			detector->setIntensityThreshold( this->intensityThreshold );
+			return detector;
+		}
+	} );
+	this->pImpl->detectorMap.insert( { "banded", [this] ()
+		{
+			PointDetector::Banded * detector = new PointDetector::Banded( this->threads );
+			detector->setIntensityThreshold( this->intensityThreshold );
+			return detector;
+		}
+	} );
+	this->pImpl->detectorMap.insert( { "brightest", [this] ()
+		{
+			PointDetector::Brightest * detector = new PointDetector::Brightest;
+			detector->setIntensityThreshold( this->intensityThreshold );
+			return detector;
+		}
+	} );
+}
+
+
+DetectorFactory::~DetectorFactory()
+{
+}
+
+
+PointDetector::APointDetector * DetectorFactory::newDetector( const std::string name ) const
+{
+	Impl::DetectorMap::const_iterator it = this->pImpl->detectorMap.find( name );
+	if( it == this->pImpl->detectorMap.end() )
+		return nullptr;
+	PointDetector::APointDetector * detector = it->second();
+	return detector;
+}
+
+
+std::vector< std::string > DetectorFactory::getAvailableDetectorNames() const
+{
+	std::vector< std::string > detectorNames;
+	for( Impl::DetectorMap::const_iterator it = this->pImpl->detectorMap.begin(); it != this->pImpl->detectorMap.end(); ++it )
+		detectorNames.push_back( it->first );
+	return detectorNames;
+}
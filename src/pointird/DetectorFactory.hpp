@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DETECTORFACTORY__INCLUDED_
+#define _DETECTORFACTORY__INCLUDED_
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace PointDetector
+{
+	class APointDetector;
+}
+
+
+class DetectorFactory
+{
+public:
+	DetectorFactory();
+	~DetectorFactory();
+
+	PointDetector::APointDetector * newDetector( const std::string name ) const;
+
+	std::vector< std::string > getAvailableDetectorNames() const;
+
+	uint8_t intensityThreshold = 127;
+	/// Threads used by each detector that splits its work - 0 for one per hardware thread.
+	unsigned int threads = 0;
+
+private:
+	class Impl;
+	std::unique_ptr< Impl > pImpl;
+};
+
+
+#endif
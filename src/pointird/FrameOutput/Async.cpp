@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Async.hpp"
+
+#include <PointIR/Frame.h>
+#include <PointIR/FramePool.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+
+
+using namespace FrameOutput;
+
+
+class Async::Impl
+{
+public:
+	// frames are copied into recycled frames and handed over by pointer - the pool has to outlive all handles
+	PointIR::FramePool pool;
+
+	// the newest frame not yet taken by the worker - older ones are dropped
+	std::mutex mutex;
+	std::condition_variable condition;
+	PointIR::FramePool::Handle mailbox;
+	bool stop = false;
+	unsigned long droppedFrames = 0;
+
+	std::thread worker;
+
+	void run( AFrameOutput & output );
+};
+
+
+void Async::Impl::run( AFrameOutput & output )
+{
+	while( true )
+	{
+		PointIR::FramePool::Handle frame;
+		{
+			std::unique_lock< std::mutex > lock( this->mutex );
+			this->condition.wait( lock, [this] { return this->mailbox || this->stop; } );
+			if( this->stop )
+				return;
+			frame = std::move( this->mailbox );
+		}
+
+		try
+		{
+			output.outputFrame( *frame );
+		}
+		catch( std::exception & ex )
+		{
+			std::cerr << std::string(__PRETTY_FUNCTION__) << std::string(": ignoring exception: ") << ex.what() << "\n";
+		}
+	}
+}
+
+
+Async::Async( AFrameOutput * output ) :
+	output( output ), pImpl( new Impl )
+{
+	this->pImpl->worker = std::thread( &Impl::run, this->pImpl.get(), std::ref( *this->output ) );
+}
+
+
+Async::~Async()
+{
+	{
+		std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+		this->pImpl->stop = true;
+	}
+	this->pImpl->condition.notify_one();
+	this->pImpl->worker.join();
+}
+
+
+void Async::outputFrame( const PointIR::Frame & frame )
+{
+	PointIR::FramePool::Handle copy = this->pImpl->pool.acquire();
+	*copy = frame;
+	{
+		std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+		if( this->pImpl->mailbox )
+			this->pImpl->droppedFrames++;
+		// the dropped frame goes back to the pool when the copy handle is destroyed
+		std::swap( this->pImpl->mailbox, copy );
+	}
+	this->pImpl->condition.notify_one();
+}
+
+
+unsigned long Async::getDroppedFrames() const
+{
+	std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+	return this->pImpl->droppedFrames;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FRAMEOUTPUT_ASYNC__INCLUDED_
+#define _FRAMEOUTPUT_ASYNC__INCLUDED_
+
+
+#include "AFrameOutput.hpp"
+
+#include <memory>
+
+
+namespace FrameOutput
+{
+
+/**
+ * Runs another frame output on its own worker thread, which only gets the newest frame.
+ */
+class Async : public AFrameOutput
+{
+public:
+	Async( const Async & ) = delete; // disable copy constructor
+	Async & operator=( const Async & other ) = delete; // disable assignment operator
+
+	/// Takes ownership of the given output.
+	Async( AFrameOutput * output );
+	virtual ~Async();
+
+	virtual void outputFrame( const PointIR::Frame & frame ) override;
+
+	AFrameOutput * getOutput() const { return this->output.get(); }
+	/// Number of frames replaced in the mailbox before the worker took them.
+	unsigned long getDroppedFrames() const;
+
+private:
+	std::unique_ptr< AFrameOutput > output;
+
+	class Impl;
+	std::unique_ptr< Impl > pImpl;
+};
+
+}
+
+
+#endif
@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CompressedStream.hpp"
+#include "../exceptions.hpp"
+#include "../../FrameCodec.hpp"
+
+#include <PointIR/Frame.h>
+#include <PointIR/FramePool.h>
+
+#include <list>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <netdb.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+
+using namespace FrameOutput;
+
+
+class CompressedStream::Impl
+{
+public:
+	struct Remote
+	{
+		int fd = 0;
+		std::vector< uint8_t > pending; // rest of a message the socket didn't take at once
+		size_t pendingOffset = 0;
+		bool needsKeyFrame = true;
+	};
+
+	int listenFD = 0;
+	std::list< Remote > remotes;
+
+	PointIR::FrameEncoder encoder;
+	std::vector< uint8_t > message;
+
+	// frames are copied into recycled frames and handed over by pointer - the pool has to outlive all handles
+	PointIR::FramePool pool;
+
+	// the newest frame not yet taken by the worker - older ones are dropped
+	std::mutex mutex;
+	std::condition_variable condition;
+	PointIR::FramePool::Handle mailbox;
+	bool stop = false;
+
+	std::thread worker;
+
+	void run();
+	void acceptRemotes();
+	bool flush( Remote & remote );
+	void sendFrame( const PointIR::Frame & frame );
+};
+
+
+static void setNonBlocking( int fd )
+{
+	int flags = fcntl( fd, F_GETFL, 0 );
+	if( -1 == flags )
+		throw SYSTEM_ERROR( errno, "fcntl" );
+	if( -1 == fcntl( fd, F_SETFL, flags | O_NONBLOCK ) )
+		throw SYSTEM_ERROR( errno, "fcntl" );
+}
+
+
+void CompressedStream::Impl::acceptRemotes()
+{
+	while( true )
+	{
+		Remote newRemote;
+		newRemote.fd = accept( this->listenFD, nullptr, nullptr );
+		if( -1 == newRemote.fd )
+		{
+			if( (EAGAIN==errno) || (EWOULDBLOCK==errno) )
+				break; // no incoming connections left
+			else
+				throw SYSTEM_ERROR( errno, "accept" );
+		}
+		setNonBlocking( newRemote.fd );
+		int noDelay = 1;
+		setsockopt( newRemote.fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay) );
+		this->remotes.push_back( newRemote );
+	}
+}
+
+
+// sends what is left of the last message - returns false if the remote is still busy
+bool CompressedStream::Impl::flush( Remote & remote )
+{
+	while( remote.pendingOffset < remote.pending.size() )
+	{
+		ssize_t sent = send( remote.fd, remote.pending.data() + remote.pendingOffset, remote.pending.size() - remote.pendingOffset, MSG_NOSIGNAL );
+		if( -1 == sent )
+		{
+			if( EAGAIN == errno || EWOULDBLOCK == errno )
+				return false;
+			throw SYSTEM_ERROR( errno, "send" );
+		}
+		remote.pendingOffset += sent;
+	}
+	remote.pending.clear();
+	remote.pendingOffset = 0;
+	return true;
+}
+
+
+void CompressedStream::Impl::sendFrame( const PointIR::Frame & frame )
+{
+	// remotes that missed a frame can't apply the following delta frames
+	for( auto & remote : this->remotes )
+	{
+		if( remote.needsKeyFrame )
+			this->encoder.requestKeyFrame();
+	}
+
+	// length prefixed message
+	this->encoder.encode( frame, this->message );
+	uint32_t length = this->message.size();
+	uint8_t prefix[4] = { (uint8_t)length, (uint8_t)( length >> 8 ), (uint8_t)( length >> 16 ), (uint8_t)( length >> 24 ) };
+	this->message.insert( this->message.begin(), prefix, prefix + 4 );
+
+	for( auto it = this->remotes.begin(); it != this->remotes.end(); )
+	{
+		try
+		{
+			if( !this->flush( *it ) )
+			{ // still busy with the last frame - skip this one
+				it->needsKeyFrame = true;
+				++it;
+				continue;
+			}
+			it->pending = this->message;
+			it->needsKeyFrame = false;
+			this->flush( *it );
+			++it;
+		}
+		catch( std::system_error & )
+		{ // remote closed connection
+			close( it->fd );
+			it = this->remotes.erase( it );
+		}
+	}
+}
+
+
+void CompressedStream::Impl::run()
+{
+	while( true )
+	{
+		PointIR::FramePool::Handle frame;
+		{
+			std::unique_lock< std::mutex > lock( this->mutex );
+			this->condition.wait( lock, [this] { return this->mailbox || this->stop; } );
+			if( this->stop )
+				return;
+			frame = std::move( this->mailbox );
+		}
+
+		try
+		{
+			this->acceptRemotes();
+			if( !this->remotes.empty() )
+				this->sendFrame( *frame );
+		}
+		catch( std::exception & ex )
+		{
+			std::cerr << std::string(__PRETTY_FUNCTION__) << std::string(": ignoring exception: ") << ex.what() << "\n";
+		}
+	}
+}
+
+
+CompressedStream::CompressedStream( const std::string & address, uint8_t noiseFloor ) :
+	pImpl( new Impl )
+{
+	this->address = address;
+	this->pImpl->encoder.setNoiseFloor( noiseFloor );
+
+	size_t separator = address.rfind( ':' );
+	if( std::string::npos == separator )
+		throw RUNTIME_ERROR( "address \"" + address + "\" is not of the form host:port" );
+	std::string host = address.substr( 0, separator );
+	std::string port = address.substr( separator + 1 );
+
+	struct addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE;
+	struct addrinfo * addresses = nullptr;
+	int error = getaddrinfo( host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &addresses );
+	if( error )
+		throw RUNTIME_ERROR( "getaddrinfo(\"" + address + "\"): " + gai_strerror( error ) );
+
+	this->pImpl->listenFD = socket( addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol );
+	if( -1 == this->pImpl->listenFD )
+	{
+		freeaddrinfo( addresses );
+		throw SYSTEM_ERROR( errno, "socket" );
+	}
+	int reuse = 1;
+	setsockopt( this->pImpl->listenFD, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse) );
+	if( -1 == bind( this->pImpl->listenFD, addresses->ai_addr, addresses->ai_addrlen ) )
+	{
+		int error = errno;
+		freeaddrinfo( addresses );
+		close( this->pImpl->listenFD );
+		throw SYSTEM_ERROR( error, "bind(\"" + address + "\")" );
+	}
+	freeaddrinfo( addresses );
+
+	if( -1 == listen( this->pImpl->listenFD, 8 ) )
+	{
+		int error = errno;
+		close( this->pImpl->listenFD );
+		throw SYSTEM_ERROR( error, "listen" );
+	}
+	try
+	{
+		setNonBlocking( this->pImpl->listenFD );
+		this->pImpl->worker = std::thread( &Impl::run, this->pImpl.get() );
+	}
+	catch( ... )
+	{
+		close( this->pImpl->listenFD );
+		throw;
+	}
+
+	std::cout << "FrameOutput::CompressedStream: serving compressed frames on \"" << this->address << "\"\n";
+}
+
+
+CompressedStream::~CompressedStream()
+{
+	{
+		std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+		this->pImpl->stop = true;
+	}
+	this->pImpl->condition.notify_one();
+	this->pImpl->worker.join();
+
+	for( auto & remote : this->pImpl->remotes )
+		close( remote.fd );
+	close( this->pImpl->listenFD );
+}
+
+
+void CompressedStream::outputFrame( const PointIR::Frame & frame )
+{
+	PointIR::FramePool::Handle copy = this->pImpl->pool.acquire();
+	*copy = frame;
+	{
+		std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+		std::swap( this->pImpl->mailbox, copy );
+	}
+	this->pImpl->condition.notify_one();
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FRAMEOUTPUT_COMPRESSEDSTREAM__INCLUDED_
+#define _FRAMEOUTPUT_COMPRESSEDSTREAM__INCLUDED_
+
+
+#include "AFrameOutput.hpp"
+
+#include <string>
+#include <memory>
+
+
+namespace FrameOutput
+{
+
+/// Streams compressed frames (see FrameCodec.hpp) to TCP clients - encoding and sending is done on a worker thread.
+class CompressedStream : public AFrameOutput
+{
+public:
+	CompressedStream( const CompressedStream & ) = delete; // disable copy constructor
+	CompressedStream & operator=( const CompressedStream & other ) = delete; // disable assignment operator
+
+	/// The address is given as "host:port" - the noise floor is passed to the encoder.
+	CompressedStream( const std::string & address = "127.0.0.1:3332", uint8_t noiseFloor = 0 );
+	virtual ~CompressedStream();
+
+	virtual void outputFrame( const PointIR::Frame & frame ) override;
+
+	const std::string & getAddress() const { return this->address; }
+
+private:
+	std::string address;
+
+	class Impl;
+	std::unique_ptr< Impl > pImpl;
+};
+
+}
+
+
+#endif
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SharedMemory.hpp"
+#include "../exceptions.hpp"
+
+#include <PointIR/Frame.h>
+#include <PointIR/SharedFrameRing.h>
+
+#include <iostream>
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+using namespace FrameOutput;
+
+
+class SharedMemory::Impl
+{
+public:
+	PointIR_SharedFrameRing * ring = nullptr;
+	PointIR_SharedFrameRing_Readers * readers = nullptr;
+	size_t mappingSize = 0;
+	uint32_t generation = 0; // always even - odd marks a replaced ring
+	unsigned int droppedFrames = 0;
+
+	void create( const std::string & name, uint32_t slotSize );
+	void destroy( const std::string & name );
+
+	uint8_t * getSlot( uint32_t index ) const
+	{
+		return reinterpret_cast< uint8_t * >( this->ring ) + POINTIR_SHAREDFRAMERING_DATA_OFFSET + index * this->ring->slotSize;
+	}
+
+	bool isPinned( uint32_t index );
+};
+
+
+/// Returns true if a live reader pinned the slot - entries of readers that are gone are freed on the way.
+bool SharedMemory::Impl::isPinned( uint32_t index )
+{
+	bool pinned = false;
+	for( PointIR_SharedFrameRing_Reader & reader : this->readers->readers )
+	{
+		uint32_t pid = __atomic_load_n( &reader.pid, __ATOMIC_SEQ_CST );
+		if( !pid || __atomic_load_n( &reader.slot, __ATOMIC_SEQ_CST ) != index + 1 )
+			continue;
+		// a reader taking over the entry meanwhile wins the swap - its pin must stay
+		if( -1 == kill( pid, 0 ) && ESRCH == errno
+		 && __atomic_compare_exchange_n( &reader.pid, &pid, POINTIR_SHAREDFRAMERING_RECLAIMING, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) )
+		{
+			__atomic_store_n( &reader.slot, 0, __ATOMIC_SEQ_CST );
+			__atomic_store_n( &reader.pid, 0, __ATOMIC_SEQ_CST );
+			continue;
+		}
+		pinned = true;
+	}
+	return pinned;
+}
+
+
+/// Creates a fresh zero filled object - readers of a previous one keep their own mapping.
+static void * createObject( const std::string & name, size_t size, mode_t mode )
+{
+	if( -1 == shm_unlink( name.c_str() ) && ENOENT != errno )
+		throw SYSTEM_ERROR( errno, "shm_unlink(\"" + name + "\")" );
+
+	int fd = shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600 );
+	if( -1 == fd )
+		throw SYSTEM_ERROR( errno, "shm_open(\"" + name + "\")" );
+
+	// set the mode regardless of the umask
+	if( -1 == fchmod( fd, mode ) || -1 == ftruncate( fd, size ) )
+	{
+		int error = errno;
+		close( fd );
+		shm_unlink( name.c_str() );
+		throw SYSTEM_ERROR( error, "creating \"" + name + "\"" );
+	}
+
+	void * mapping = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	int error = errno;
+	close( fd );
+	if( MAP_FAILED == mapping )
+	{
+		shm_unlink( name.c_str() );
+		throw SYSTEM_ERROR( error, "mmap(\"" + name + "\")" );
+	}
+	return mapping;
+}
+
+
+void SharedMemory::Impl::create( const std::string & name, uint32_t slotSize )
+{
+	// Readers need write access to pin slots - the pins get their own object, so they can map the ring read only.
+	// Both are only shared with the group of pointird. The pins are created first, so readers finding the ring also find them.
+	std::string readersName = name + POINTIR_SHAREDFRAMERING_READERS_SUFFIX;
+	this->readers = static_cast< PointIR_SharedFrameRing_Readers * >(
+		createObject( readersName, sizeof(PointIR_SharedFrameRing_Readers), 0660 ) );
+	__atomic_store_n( &this->readers->generation, this->generation, __ATOMIC_RELEASE );
+
+	size_t size = POINTIR_SHAREDFRAMERING_DATA_OFFSET + POINTIR_SHAREDFRAMERING_SLOTS * (size_t)slotSize;
+	try
+	{
+		this->ring = static_cast< PointIR_SharedFrameRing * >( createObject( name, size, 0660 ) );
+	}
+	catch( ... )
+	{
+		munmap( this->readers, sizeof(PointIR_SharedFrameRing_Readers) );
+		this->readers = nullptr;
+		shm_unlink( readersName.c_str() );
+		throw;
+	}
+
+	this->mappingSize = size;
+	this->ring->version = POINTIR_SHAREDFRAMERING_VERSION;
+	this->ring->generation = this->generation;
+	this->ring->slotCount = POINTIR_SHAREDFRAMERING_SLOTS;
+	this->ring->slotSize = slotSize;
+	__atomic_store_n( &this->ring->magic, POINTIR_SHAREDFRAMERING_MAGIC, __ATOMIC_RELEASE );
+}
+
+
+void SharedMemory::Impl::destroy( const std::string & name )
+{
+	if( !this->ring )
+		return;
+
+	// tell readers that these objects are gone - they keep their mapping until they notice
+	// unlinked first, so a reader that still finds the old ring by name also finds its reader counts
+	int unlinkError = 0;
+	for( const std::string & objectName : { name, name + POINTIR_SHAREDFRAMERING_READERS_SUFFIX } )
+	{
+		if( -1 == shm_unlink( objectName.c_str() ) && ENOENT != errno && !unlinkError )
+			unlinkError = errno;
+	}
+	__atomic_store_n( &this->ring->generation, this->generation + 1, __ATOMIC_RELEASE );
+	this->generation += 2;
+
+	munmap( this->ring, this->mappingSize );
+	munmap( this->readers, sizeof(PointIR_SharedFrameRing_Readers) );
+	this->ring = nullptr;
+	this->readers = nullptr;
+	this->mappingSize = 0;
+
+	if( unlinkError )
+		throw SYSTEM_ERROR( unlinkError, "shm_unlink(\"" + name + "\")" );
+}
+
+
+SharedMemory::SharedMemory( const std::string & name ) :
+	pImpl( new Impl )
+{
+	this->name = name;
+
+	// slots are sized on the first frame
+	this->pImpl->create( this->name, 0 );
+
+	std::cout << "FrameOutput::SharedMemory: publishing frames in \"" << this->name << "\"\n";
+}
+
+
+SharedMemory::~SharedMemory()
+{
+	try
+	{
+		this->pImpl->destroy( this->name );
+	}
+	catch( std::exception & ex )
+	{
+		std::cerr << std::string(__PRETTY_FUNCTION__) << std::string(": ignoring exception: ") << ex.what() << "\n";
+	}
+}
+
+
+void SharedMemory::outputFrame( const PointIR::Frame & frame )
+{
+	size_t packetSize = frame.getSerializedSize();
+
+	if( packetSize > this->pImpl->ring->slotSize )
+	{
+		// round up to whole pages so every slot starts page aligned
+		size_t pageSize = sysconf( _SC_PAGESIZE );
+		uint32_t slotSize = ( ( packetSize + pageSize - 1 ) / pageSize ) * pageSize;
+		this->pImpl->destroy( this->name );
+		this->pImpl->create( this->name, slotSize );
+		std::cout << "FrameOutput::SharedMemory: resized slots to " << slotSize << " bytes\n";
+	}
+
+	PointIR_SharedFrameRing * ring = this->pImpl->ring;
+	uint32_t latest = __atomic_load_n( &ring->latest, __ATOMIC_RELAXED );
+
+	// find a slot no reader has pinned - the latest frame is only overwritten if all others are pinned
+	for( uint32_t i = 1; i <= POINTIR_SHAREDFRAMERING_SLOTS; i++ )
+	{
+		uint32_t index = ( latest + i ) % POINTIR_SHAREDFRAMERING_SLOTS;
+		PointIR_SharedFrameRing_Slot & slot = ring->slots[index];
+		if( this->pImpl->isPinned( index ) )
+			continue;
+
+		// mark the slot as being written, then check again for readers that pinned it meanwhile
+		// readers store their pin before checking the sequence, so one of us always sees the other
+		uint32_t sequence = __atomic_load_n( &slot.sequence, __ATOMIC_RELAXED );
+		__atomic_store_n( &slot.sequence, sequence + 1, __ATOMIC_SEQ_CST );
+		if( this->pImpl->isPinned( index ) )
+		{
+			__atomic_store_n( &slot.sequence, sequence + 2, __ATOMIC_RELEASE );
+			continue;
+		}
+
+		frame.serialize( this->pImpl->getSlot( index ) );
+
+		__atomic_store_n( &slot.sequence, sequence + 2, __ATOMIC_RELEASE );
+		__atomic_store_n( &ring->latest, index, __ATOMIC_RELEASE );
+		__atomic_add_fetch( &ring->published, 1, __ATOMIC_RELEASE );
+		return;
+	}
+
+	// all slots pinned - only happens with more readers than slots
+	if( !( this->pImpl->droppedFrames++ % 100 ) )
+		std::cerr << std::string(__PRETTY_FUNCTION__) << ": all slots in use - dropped " << this->pImpl->droppedFrames << " frames so far\n";
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FRAMEOUTPUT_SHAREDMEMORY__INCLUDED_
+#define _FRAMEOUTPUT_SHAREDMEMORY__INCLUDED_
+
+
+#include "AFrameOutput.hpp"
+
+#include <string>
+#include <memory>
+
+
+namespace FrameOutput
+{
+
+/// Publishes frames into POSIX shared memory - see PointIR/SharedFrameRing.h for the layout.
+class SharedMemory : public AFrameOutput
+{
+public:
+	SharedMemory( const SharedMemory & ) = delete; // disable copy constructor
+	SharedMemory & operator=( const SharedMemory & other ) = delete; // disable assignment operator
+
+	SharedMemory() : SharedMemory( "/PointIR.video" ) {}
+	SharedMemory( const std::string & name );
+	virtual ~SharedMemory();
+
+	virtual void outputFrame( const PointIR::Frame & frame ) override;
+
+	const std::string & getName() const { return this->name; }
+
+private:
+	std::string name;
+
+	class Impl;
+	std::unique_ptr< Impl > pImpl;
+};
+
+}
+
+
+#endif
@@ -21,8 +21,14 @@
 #include "../exceptions.hpp"
 
 #include <PointIR/Frame.h>
+#include <PointIR/FrameRequest.h>
 
 #include <list>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <chrono>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -37,6 +43,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/uio.h>
 #include <malloc.h>
 
 
@@ -46,17 +53,107 @@ using namespace FrameOutput;
 class UnixDomainSocket::Impl
 {
 public:
+	typedef std::chrono::steady_clock Clock;
+
+	// cropped region and decimation of a frame - clamped to the current frame size
+	typedef std::tuple< uint32_t, uint32_t, uint32_t, uint32_t, uint32_t > VariantKey;
+
+	struct Variant
+	{
+		uint64_t frameNumber = 0;
+		std::vector< uint8_t > packet;
+	};
+
 	struct Socket
 	{
 		struct sockaddr_un addr;
 		int fd = 0;
+		PointIR_FrameRequest request = {};
+		Clock::time_point lastSent;
+		unsigned int socketBufferSize = 0;
 	};
 	Socket local;
 	std::list< Socket > remotes;
-	unsigned int socketBufferSize = 0;
+
+	uint64_t frameNumber = 0;
+	std::map< VariantKey, Variant > variants;
+
+	void receiveRequests();
+	VariantKey variantKey( const PointIR_FrameRequest & request, const PointIR::Frame & frame ) const;
+	const std::vector< uint8_t > & variant( const VariantKey & key, const PointIR::Frame & frame );
 };
 
 
+// reads the latest request each client sent - requests may be updated at any time
+void UnixDomainSocket::Impl::receiveRequests()
+{
+	for( auto & remote : this->remotes )
+	{
+		while( true )
+		{
+			PointIR_FrameRequest request;
+			ssize_t received = recv( remote.fd, &request, sizeof(request), MSG_DONTWAIT );
+			if( sizeof(request) != received )
+				break; // nothing left - errors and closed connections are handled when sending
+			remote.request = request;
+		}
+	}
+}
+
+
+UnixDomainSocket::Impl::VariantKey UnixDomainSocket::Impl::variantKey( const PointIR_FrameRequest & request, const PointIR::Frame & frame ) const
+{
+	uint32_t x = std::min( request.cropX, frame.getWidth() );
+	uint32_t y = std::min( request.cropY, frame.getHeight() );
+	uint32_t width = frame.getWidth() - x;
+	uint32_t height = frame.getHeight() - y;
+	if( request.cropWidth )
+		width = std::min( width, request.cropWidth );
+	if( request.cropHeight )
+		height = std::min( height, request.cropHeight );
+	uint32_t decimation = std::max( request.decimation, 1u );
+	return VariantKey( x, y, width, height, decimation );
+}
+
+
+// builds each variant at most once per frame
+const std::vector< uint8_t > & UnixDomainSocket::Impl::variant( const VariantKey & key, const PointIR::Frame & frame )
+{
+	Variant & variant = this->variants[key];
+	if( variant.frameNumber == this->frameNumber )
+		return variant.packet;
+	variant.frameNumber = this->frameNumber;
+
+	uint32_t x, y, width, height, decimation;
+	std::tie( x, y, width, height, decimation ) = key;
+	uint32_t outWidth = ( width + decimation - 1 ) / decimation;
+	uint32_t outHeight = ( height + decimation - 1 ) / decimation;
+
+	variant.packet.resize( sizeof(PointIR_Frame) + outWidth * outHeight );
+	PointIR_Frame * packet = reinterpret_cast< PointIR_Frame * >( variant.packet.data() );
+	packet->width = outWidth;
+	packet->height = outHeight;
+
+	uint8_t * out = packet->data;
+	for( uint32_t row = 0; row < outHeight; row++ )
+	{
+		const uint8_t * in = &frame.getAt( x, y + row * decimation );
+		if( 1 == decimation )
+		{
+			memcpy( out, in, outWidth );
+			out += outWidth;
+		}
+		else
+		{
+			for( uint32_t column = 0; column < outWidth; column++ )
+				*out++ = in[ column * decimation ];
+		}
+	}
+
+	return variant.packet;
+}
+
+
 static void unlinkSocket( const std::string & socketPath )
 {
 	struct stat st;
@@ -130,17 +227,10 @@ UnixDomainSocket::~UnixDomainSocket()
 
 void UnixDomainSocket::outputFrame( const PointIR::Frame & frame )
 {
-	const PointIR_Frame * packet = static_cast<const PointIR_Frame*>(frame);
-	size_t packetSize = sizeof(PointIR_Frame) + packet->width * packet->height;
-
-	// resize socket buffers if needed - doesn't seem necessary for SOCK_SEQPACKET
-	if( this->pImpl->socketBufferSize != packetSize )
-	{
-		this->pImpl->socketBufferSize = packetSize;
-		for( auto & remote : this->pImpl->remotes )
-			setsockopt( remote.fd, SOL_SOCKET, SO_SNDBUF, &(this->pImpl->socketBufferSize), sizeof(this->pImpl->socketBufferSize) );
-		std::cout << "FrameOutput::UnixDomainSocket: resized socket send buffers to "<< this->pImpl->socketBufferSize << "\n";
-	}
+	// the full frame is sent straight from the frame's pixels
+	PointIR_Frame fullHeader;
+	fullHeader.width = frame.getWidth();
+	fullHeader.height = frame.getHeight();
 
 	// accept all incoming connections
 	while( true )
@@ -163,20 +253,59 @@ void UnixDomainSocket::outputFrame( const PointIR::Frame & frame )
 		if( -1 == fcntl( newRemote.fd, F_SETFL, flags | O_NONBLOCK ) )
 			throw SYSTEM_ERROR( errno, "fcntl" );
 
-		// resize socket send buffer to fit one frame - doesn't seem necessary for SOCK_SEQPACKET
-		setsockopt( newRemote.fd, SOL_SOCKET, SO_SNDBUF, &(this->pImpl->socketBufferSize), sizeof(this->pImpl->socketBufferSize) );
-
 		this->pImpl->remotes.push_back( newRemote );
 	}
 
-	// send frame packet - removing remotes on the fly if disconnected
+	this->pImpl->receiveRequests();
+	this->pImpl->frameNumber++;
+	Impl::Clock::time_point now = Impl::Clock::now();
+
+	// send frame packets - removing remotes on the fly if disconnected
 	for( auto it = this->pImpl->remotes.begin(); it != this->pImpl->remotes.end(); )
 	{
-		ssize_t sent = send( it->fd, packet, packetSize, MSG_NOSIGNAL );
+		// skip remotes not wanting another frame yet - with a little slack for capture jitter
+		if( it->request.maxFPS && now - it->lastSent < std::chrono::microseconds( 900000 / it->request.maxFPS ) )
+		{
+			++it;
+			continue;
+		}
+
+		struct iovec parts[2];
+		struct msghdr message = {};
+		message.msg_iov = parts;
+		size_t packetSize;
+		Impl::VariantKey key = this->pImpl->variantKey( it->request, frame );
+		if( key == Impl::VariantKey( 0, 0, frame.getWidth(), frame.getHeight(), 1 ) && frame.isContiguous() )
+		{
+			parts[0].iov_base = &fullHeader;
+			parts[0].iov_len = sizeof(PointIR_Frame);
+			parts[1].iov_base = const_cast< uint8_t * >( frame.getData() );
+			parts[1].iov_len = frame.size();
+			message.msg_iovlen = 2;
+			packetSize = frame.getSerializedSize();
+		}
+		else
+		{
+			const std::vector< uint8_t > & variant = this->pImpl->variant( key, frame );
+			parts[0].iov_base = const_cast< uint8_t * >( variant.data() );
+			parts[0].iov_len = variant.size();
+			message.msg_iovlen = 1;
+			packetSize = variant.size();
+		}
+
+		// resize socket send buffer to fit one frame - doesn't seem necessary for SOCK_SEQPACKET
+		if( it->socketBufferSize < packetSize )
+		{
+			it->socketBufferSize = packetSize;
+			setsockopt( it->fd, SOL_SOCKET, SO_SNDBUF, &(it->socketBufferSize), sizeof(it->socketBufferSize) );
+		}
+
+		ssize_t sent = sendmsg( it->fd, &message, MSG_NOSIGNAL );
 		if( -1 == sent )
 		{
 			if( EPIPE == errno || ECONNRESET == errno )
 			{ // remote closed connection
+				close( it->fd );
 				it = this->pImpl->remotes.erase( it );
 				continue;
 			}
@@ -185,7 +314,7 @@ void UnixDomainSocket::outputFrame( const PointIR::Frame & frame )
 //				std::cerr << std::string(__PRETTY_FUNCTION__) << ": remote for descriptor " << it->fd << " too slow - skipping" << "\n";
 			}
 			else
-				throw SYSTEM_ERROR( errno, "send" );
+				throw SYSTEM_ERROR( errno, "sendmsg" );
 		}
 		else if( (size_t)sent != packetSize )
 		{ // incomplete transfer - not handled - disconnect to be safe
@@ -194,6 +323,17 @@ void UnixDomainSocket::outputFrame( const PointIR::Frame & frame )
 			it = this->pImpl->remotes.erase( it );
 			continue;
 		}
+		else
+			it->lastSent = now;
 		++it;
 	}
+
+	// forget variants no remote asked for in a while
+	for( auto it = this->pImpl->variants.begin(); it != this->pImpl->variants.end(); )
+	{
+		if( this->pImpl->frameNumber - it->second.frameNumber > 100 )
+			it = this->pImpl->variants.erase( it );
+		else
+			++it;
+	}
 }
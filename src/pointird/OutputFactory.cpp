@@ -25,6 +25,8 @@
 #include "PointOutput/APointOutput.hpp"
 
 #include "PointOutput/DebugOpenCV.hpp"
+#include "PointOutput/Async.hpp"
+#include "FrameOutput/Async.hpp"
 
 #ifdef POINTIR_UINPUT
 	#include "PointOutput/Uinput.hpp"
@@ -35,6 +37,15 @@
 	#include "FrameOutput/UnixDomainSocket.hpp"
 #endif
 
+#ifdef POINTIR_SHAREDMEMORY
+	#include "PointOutput/SharedMemory.hpp"
+	#include "FrameOutput/SharedMemory.hpp"
+#endif
+
+#ifdef POINTIR_FRAMESTREAM
+	#include "FrameOutput/CompressedStream.hpp"
+#endif
+
 #ifdef POINTIR_TUIO
 	#include "PointOutput/TUIO.hpp"
 #endif
@@ -45,6 +56,9 @@
 
 #include <map>
 #include <functional>
+#include <sstream>
+#include <algorithm>
+#include <iostream>
 
 
 class OutputFactory::Impl
@@ -60,14 +74,29 @@ public:
 };
 
 
+#ifdef POINTIR_UINPUT
+static PointOutput::Uinput::Settings uinputSettings( const OutputFactory & factory )
+{
+	PointOutput::Uinput::Settings settings;
+	settings.width = factory.uinputWidth;
+	settings.height = factory.uinputHeight;
+	settings.resolution = factory.uinputResolution;
+	settings.fuzz = factory.uinputFuzz;
+	settings.deadband = factory.uinputDeadband;
+	settings.stationaryInterval = factory.uinputStationaryInterval;
+	return settings;
+}
+#endif
+
+
 OutputFactory::OutputFactory() : pImpl( new Impl )
 {
 #ifdef POINTIR_UINPUT
-	this->pImpl->pointOutputMap.insert( { "uinput", [] ()
-		{ return new PointOutput::Uinput; }
+	this->pImpl->pointOutputMap.insert( { "uinput", [this] ()
+		{ return new PointOutput::Uinput( false, uinputSettings( *this ) ); }
 	} );
 	this->pImpl->pointOutputMap.insert( { "uinputB", [this] ()
-		{ return new PointOutput::Uinput( &(this->trackerFactory) ); }
+		{ return new PointOutput::Uinput( true, uinputSettings( *this ) ); }
 	} );
 #endif
 #ifdef POINTIR_UNIXDOMAINSOCKET
@@ -75,20 +104,33 @@ OutputFactory::OutputFactory() : pImpl( new Impl )
 		{ return new PointOutput::UnixDomainSocket; }
 	} );
 #endif
+#ifdef POINTIR_SHAREDMEMORY
+	this->pImpl->pointOutputMap.insert( { "shm", [] ()
+		{ return new PointOutput::SharedMemory; }
+	} );
+#endif
 #ifdef POINTIR_TUIO
 	this->pImpl->pointOutputMap.insert( { "tuio", [this] ()
 		{
+			std::vector< std::string > addresses = this->tuioAddresses;
 			char * addr = getenv("POINTIR_TUIO_ADDRESS");
-			if( addr )
-				return new PointOutput::TUIO( this->trackerFactory, addr );
-			else
-				return new PointOutput::TUIO( this->trackerFactory );
+			if( addresses.empty() && addr )
+			{
+				std::stringstream list( addr );
+				std::string address;
+				while( std::getline( list, address, ',' ) )
+					if( !address.empty() )
+						addresses.push_back( address );
+			}
+			if( addresses.empty() )
+				addresses.push_back( "osc.udp://127.0.0.1:3333" );
+			return new PointOutput::TUIO( addresses, this->tuioBlobs );
 		}
 	} );
 #endif
 #ifdef POINTIR_WIN8TOUCHINJECTION
-	this->pImpl->pointOutputMap.insert( { "win8", [this] ()
-		{ return new PointOutput::Win8TouchInjection( this->trackerFactory ); }
+	this->pImpl->pointOutputMap.insert( { "win8", [] ()
+		{ return new PointOutput::Win8TouchInjection; }
 	} );
 #endif
 	this->pImpl->pointOutputMap.insert( { "debugcv", [this] () -> PointOutput::APointOutput *
@@ -105,6 +147,16 @@ OutputFactory::OutputFactory() : pImpl( new Impl )
 		{ return new FrameOutput::UnixDomainSocket; }
 	} );
 #endif
+#ifdef POINTIR_FRAMESTREAM
+	this->pImpl->frameOutputMap.insert( { "stream", [this] ()
+		{ return new FrameOutput::CompressedStream( this->frameStreamAddress, this->frameStreamNoiseFloor ); }
+	} );
+#endif
+#ifdef POINTIR_SHAREDMEMORY
+	this->pImpl->frameOutputMap.insert( { "shm", [] ()
+		{ return new FrameOutput::SharedMemory; }
+	} );
+#endif
 }
 
 
@@ -119,6 +171,14 @@ PointOutput::APointOutput * OutputFactory::newPointOutput( const std::string nam
 	if( it == this->pImpl->pointOutputMap.end() )
 		return nullptr;
 	PointOutput::APointOutput * output = it->second();
+	if( output && this->isAsync( name ) )
+	{
+		// the debug output reads the processor's frame and unprojector, which are only valid during the call
+		if( dynamic_cast< PointOutput::DebugOpenCV * >( output ) )
+			std::cerr << "OutputFactory: point output \"" << name << "\" can't run asynchronously - running it synchronously\n";
+		else
+			output = new PointOutput::Async( output );
+	}
 	return output;
 }
 
@@ -129,10 +189,18 @@ FrameOutput::AFrameOutput * OutputFactory::newFrameOutput( const std::string nam
 	if( it == this->pImpl->frameOutputMap.end() )
 		return nullptr;
 	FrameOutput::AFrameOutput * output = it->second();
+	if( output && this->isAsync( name ) )
+		output = new FrameOutput::Async( output );
 	return output;
 }
 
 
+bool OutputFactory::isAsync( const std::string & name ) const
+{
+	return std::find( this->asyncOutputNames.begin(), this->asyncOutputNames.end(), name ) != this->asyncOutputNames.end();
+}
+
+
 std::vector< std::string > OutputFactory::getAvailablePointOutputNames() const
 {
 	std::vector< std::string > outputs;
@@ -21,8 +21,6 @@
 #define _OUTPUTFACTORY__INCLUDED_
 
 
-#include "TrackerFactory.hpp"
-
 #include <memory>
 #include <string>
 #include <vector>
@@ -55,9 +53,27 @@ public:
 	std::vector< std::string > getAvailableOutputNames() const;
 
 	const Processor * processor = nullptr;
-	TrackerFactory trackerFactory;
+
+	/// Outputs with these names are run on their own worker thread, so they can't delay the processor or other outputs.
+	std::vector< std::string > asyncOutputNames;
+
+	int uinputWidth = 32768;
+	int uinputHeight = 32768;
+	int uinputResolution = 0;
+	int uinputFuzz = 0;
+	int uinputDeadband = 0;
+	float uinputStationaryInterval = 0.1f;
+
+	/// Destinations of the TUIO output - if empty, the comma separated list in POINTIR_TUIO_ADDRESS or "osc.udp://127.0.0.1:3333" is used.
+	std::vector< std::string > tuioAddresses;
+	bool tuioBlobs = false;
+
+	std::string frameStreamAddress = "127.0.0.1:3332";
+	int frameStreamNoiseFloor = 0;
 
 private:
+	bool isAsync( const std::string & name ) const;
+
 	class Impl;
 	std::unique_ptr< Impl > pImpl;
 };
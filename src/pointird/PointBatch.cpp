@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PointBatch.hpp"
+
+#include <PointIR/PointArray.h>
+
+#include <algorithm>
+
+
+void PointBatch::resize( size_t count )
+{
+	this->count = count;
+	if( this->x.size() >= count )
+		return;
+	this->x.resize( count );
+	this->y.resize( count );
+	this->size.resize( count );
+	this->intensity.resize( count );
+	this->id.resize( count );
+	this->timestamp.resize( count );
+}
+
+
+void PointBatch::assignPositions( const PointIR::PointArray & pointArray )
+{
+	this->resize( pointArray.size() );
+	for( size_t i = 0; i < this->count; i++ )
+	{
+		this->x[i] = pointArray[i].x;
+		this->y[i] = pointArray[i].y;
+	}
+}
+
+
+void PointBatch::assign( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs, uint64_t timestamp )
+{
+	this->assignPositions( pointArray );
+	for( size_t i = 0; i < this->count; i++ )
+	{
+		this->size[i] = i < blobs.size() ? blobs[i].area : 0.0f;
+		this->intensity[i] = i < blobs.size() ? blobs[i].intensity : 0.0f;
+	}
+	std::fill_n( this->id.begin(), this->count, -1 );
+	std::fill_n( this->timestamp.begin(), this->count, timestamp );
+}
+
+
+void PointBatch::toPointArray( PointIR::PointArray & pointArray ) const
+{
+	pointArray.resizeIfNeeded( this->count );
+	for( size_t i = 0; i < this->count; i++ )
+	{
+		pointArray[i].x = this->x[i];
+		pointArray[i].y = this->y[i];
+	}
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTBATCH__INCLUDED_
+#define _POINTBATCH__INCLUDED_
+
+
+#include <PointIR/Blob.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+
+namespace PointIR
+{
+	class PointArray;
+}
+
+
+/**
+ * Points stored as one contiguous column per component, so stages working on many points at once can use wide vector loads.
+ * Only used inside the daemon - points are converted to PointIR_PointArray at the output boundary.
+ *
+ * The columns are only resized, never shrunk, so a batch that is reused each frame stops allocating after a few frames.
+ */
+class PointBatch
+{
+public:
+	std::vector< float > x;
+	std::vector< float > y;
+	std::vector< float > size;         ///< area of the blob
+	std::vector< float > intensity;
+	std::vector< int > id;             ///< -1 if not tracked
+	std::vector< uint64_t > timestamp; ///< in microseconds of a monotonic clock
+
+	size_t getCount() const { return this->count; }
+	bool empty() const { return !this->count; }
+
+	/// Changes the number of points - new points are undefined.
+	void resize( size_t count );
+
+	/// Takes the positions only - the other columns are undefined, for stages that only look at the positions.
+	void assignPositions( const PointIR::PointArray & pointArray );
+	/// Takes the positions and the size and intensity of each blob - the points are not tracked yet.
+	void assign( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs, uint64_t timestamp );
+
+	/// Copies all components of the point at index "from" over the one at index "to".
+	void copyPoint( size_t to, size_t from )
+	{
+		this->x[to] = this->x[from];
+		this->y[to] = this->y[from];
+		this->size[to] = this->size[from];
+		this->intensity[to] = this->intensity[from];
+		this->id[to] = this->id[from];
+		this->timestamp[to] = this->timestamp[from];
+	}
+
+	/// Writes the positions back.
+	void toPointArray( PointIR::PointArray & pointArray ) const;
+
+private:
+	size_t count = 0;
+};
+
+
+#endif
@@ -21,6 +21,11 @@
 #define _APOINTDETECTOR__INCLUDED_
 
 
+#include <PointIR/Blob.h>
+
+#include <vector>
+
+
 namespace PointIR
 {
 	class Frame;
@@ -28,13 +33,26 @@ namespace PointIR
 }
 
 
+namespace Unprojector
+{
+	class ScreenMask;
+}
+
+
 namespace PointDetector
 {
 
 class APointDetector
 {
 public:
-	virtual void detect( PointIR::PointArray & pointArray, const PointIR::Frame & frame ) = 0;
+	/// Fills the point array and the extents of each point.
+	virtual void detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame ) = 0;
+	/// Only searches the pixels covered by the mask, which has the size of the frame. Searches the whole frame unless overridden.
+	virtual void detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame,
+	                     const Unprojector::ScreenMask & mask )
+	{
+		this->detect( pointArray, blobs, frame );
+	}
 };
 
 }
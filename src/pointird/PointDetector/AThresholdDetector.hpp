@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATHRESHOLDDETECTOR__INCLUDED_
+#define _ATHRESHOLDDETECTOR__INCLUDED_
+
+
+#include "APointDetector.hpp"
+
+#include <atomic>
+
+#include <stdint.h>
+
+
+namespace PointDetector
+{
+
+/// Detects points as connected areas of pixels at or above an intensity threshold.
+/// The parameters may be changed from any thread - each is read once per frame.
+class AThresholdDetector : public APointDetector
+{
+public:
+	void setIntensityThreshold( uint8_t threshold ) { this->intensityThreshold = threshold; }
+	uint8_t getIntensityThreshold() const { return this->intensityThreshold; }
+
+	/// Drops areas whose bounding box is smaller or larger than the given sizes, relative to the average side of the frame.
+	void setBoundingFilterEnabled( bool enable ) { this->boundingFilterEnabled = enable; }
+	bool isBoundingFilterEnabled() const { return this->boundingFilterEnabled; }
+	void setMinBoundingSize( float minBoundingSize ) { this->minBoundingSize = minBoundingSize; }
+	void setMaxBoundingSize( float maxBoundingSize ) { this->maxBoundingSize = maxBoundingSize; }
+	float getMinBoundingSize() const { return this->minBoundingSize; }
+	float getMaxBoundingSize() const { return this->maxBoundingSize; }
+
+protected:
+	std::atomic< uint8_t > intensityThreshold { 127 };
+	std::atomic< bool > boundingFilterEnabled { false };
+	std::atomic< float > minBoundingSize { 0.0002f };
+	std::atomic< float > maxBoundingSize { 0.125f };
+};
+
+}
+
+
+#endif
@@ -0,0 +1,426 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Banded.hpp"
+#include "../ThreadPool.hpp"
+#include "../Unprojector/ScreenMask.hpp"
+
+#include <PointIR/Frame.h>
+#include <PointIR/PointArray.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <assert.h>
+
+
+using namespace PointDetector;
+
+
+// bands get at least this many rows - smaller ones don't pay off the synchronization
+static const unsigned int minBandHeight = 16;
+
+
+// pixels of the thresholded frame - one bit per pixel, the lowest bit is the leftmost pixel
+typedef uint64_t MaskWord;
+static const unsigned int maskWordBits = 64;
+
+
+// sets the bits of the pixels in [start,end) at or above the threshold - the other bits of the row must be cleared
+static void thresholdRow( MaskWord * words, const uint8_t * row, unsigned int start, unsigned int end, uint8_t threshold )
+{
+	unsigned int x = start;
+	for( ; x < end && x % maskWordBits; x++ )
+		words[x / maskWordBits] |= (MaskWord)( row[x] >= threshold ) << ( x % maskWordBits );
+	// whole words without branches
+	for( ; x + maskWordBits <= end; x += maskWordBits )
+	{
+		const uint8_t * pixels = row + x;
+		MaskWord word = 0;
+		for( unsigned int bit = 0; bit < maskWordBits; bit++ )
+			word |= (MaskWord)( pixels[bit] >= threshold ) << bit;
+		words[x / maskWordBits] = word;
+	}
+	for( ; x < end; x++ )
+		words[x / maskWordBits] |= (MaskWord)( row[x] >= threshold ) << ( x % maskWordBits );
+}
+
+
+// the first pixel at or after x whose bit equals set - numWords * maskWordBits if there is none
+static unsigned int findBit( const MaskWord * words, unsigned int numWords, unsigned int x, bool set )
+{
+	unsigned int w = x / maskWordBits;
+	if( w >= numWords )
+		return numWords * maskWordBits;
+	MaskWord invert = set ? 0 : ~(MaskWord)0;
+	MaskWord word = ( words[w] ^ invert ) & ( ~(MaskWord)0 << ( x % maskWordBits ) );
+	// whole words without a match are skipped
+	while( !word )
+	{
+		if( ++w == numWords )
+			return numWords * maskWordBits;
+		word = words[w] ^ invert;
+	}
+	return w * maskWordBits + __builtin_ctzll( word );
+}
+
+
+// a horizontal sequence of bright pixels within one row - [start,end)
+struct Run
+{
+	unsigned int y;
+	unsigned int start;
+	unsigned int end;
+	unsigned int parent; // index of a run of the same area, the first run of an area is its own parent
+	uint8_t peak;
+};
+
+
+// the moments of a set of touching runs - pixel coordinates are whole numbers, so they are summed exactly as integers
+// and only converted once per area
+struct Area
+{
+	uint64_t count = 0;
+	uint64_t sumX = 0;
+	uint64_t sumY = 0;
+	uint64_t sumXX = 0;
+	uint64_t sumYY = 0;
+	uint64_t sumXY = 0;
+	unsigned int minX = 0;
+	unsigned int maxX = 0;
+	unsigned int minY = 0;
+	unsigned int maxY = 0;
+	uint8_t peak = 0;
+	unsigned int parent = 0; // used to join areas across seams
+
+	void add( const Run & run )
+	{
+		uint64_t length = run.end - run.start;
+		uint64_t first = run.start;
+		uint64_t last = run.end - 1;
+		uint64_t y = run.y;
+		// closed forms of the sums of x and x^2 over the run - both divisions are exact
+		uint64_t sumX = length * ( first + last ) / 2;
+		uint64_t sumXX = ( last * ( last + 1 ) * ( 2 * last + 1 ) - ( first ? ( first - 1 ) * first * ( 2 * first - 1 ) : 0 ) ) / 6;
+		if( !this->count )
+		{
+			this->minX = run.start;
+			this->maxX = run.end - 1;
+			this->minY = this->maxY = run.y;
+		}
+		this->count += length;
+		this->sumX += sumX;
+		this->sumY += length * y;
+		this->sumXX += sumXX;
+		this->sumYY += length * y * y;
+		this->sumXY += sumX * y;
+		this->minX = std::min( this->minX, run.start );
+		this->maxX = std::max( this->maxX, run.end - 1 );
+		this->minY = std::min( this->minY, run.y );
+		this->maxY = std::max( this->maxY, run.y );
+		this->peak = std::max( this->peak, run.peak );
+	}
+
+	void add( const Area & other )
+	{
+		this->count += other.count;
+		this->sumX += other.sumX;
+		this->sumY += other.sumY;
+		this->sumXX += other.sumXX;
+		this->sumYY += other.sumYY;
+		this->sumXY += other.sumXY;
+		this->minX = std::min( this->minX, other.minX );
+		this->maxX = std::max( this->maxX, other.maxX );
+		this->minY = std::min( this->minY, other.minY );
+		this->maxY = std::max( this->maxY, other.maxY );
+		this->peak = std::max( this->peak, other.peak );
+	}
+
+	// the centroid is the point, the extents are those of a rectangle with the same second moments
+	void toPoint( PointIR::Point & point, PointIR::Blob & blob ) const
+	{
+		const double pi = 3.14159265358979;
+		double count = this->count;
+		double meanX = this->sumX / count;
+		double meanY = this->sumY / count;
+		// each pixel covers a unit square, which adds 1/12 to the variance of the pixel centers
+		double varianceX = this->sumXX / count - meanX * meanX + 1.0 / 12.0;
+		double varianceY = this->sumYY / count - meanY * meanY + 1.0 / 12.0;
+		double covariance = this->sumXY / count - meanX * meanY;
+		double mean = ( varianceX + varianceY ) / 2.0;
+		double deviation = std::sqrt( ( varianceX - varianceY ) * ( varianceX - varianceY ) / 4.0 + covariance * covariance );
+		double angle = 0.5 * std::atan2( 2.0 * covariance, varianceX - varianceY );
+		if( angle < 0.0 )
+			angle += pi;
+		if( angle >= pi )
+			angle -= pi;
+		point.x = meanX;
+		point.y = meanY;
+		blob = PointIR::Blob( (float)std::sqrt( 12.0 * ( mean + deviation ) ), (float)std::sqrt( 12.0 * std::max( 0.0, mean - deviation ) ),
+		                      (float)this->count, (float)angle, this->peak / 255.0f );
+	}
+};
+
+
+template< typename T >
+static unsigned int findRoot( std::vector< T > & elements, unsigned int i )
+{
+	while( elements[i].parent != i )
+	{
+		elements[i].parent = elements[elements[i].parent].parent;
+		i = elements[i].parent;
+	}
+	return i;
+}
+
+
+// the earlier element stays the root, so areas keep the order of their first runs
+template< typename T >
+static void join( std::vector< T > & elements, unsigned int a, unsigned int b )
+{
+	a = findRoot( elements, a );
+	b = findRoot( elements, b );
+	if( a < b )
+		elements[b].parent = a;
+	else if( b < a )
+		elements[a].parent = b;
+}
+
+
+// calls joinRuns for each pair of runs touching each other - the runs of both ranges are sorted by their start
+template< typename F >
+static void forTouchingRuns( const std::vector< Run > & upperRuns, size_t upperBegin, size_t upperEnd,
+                             const std::vector< Run > & lowerRuns, size_t lowerBegin, size_t lowerEnd, F joinRuns )
+{
+	size_t upper = upperBegin;
+	for( size_t lower = lowerBegin; lower < lowerEnd; lower++ )
+	{
+		// skip upper runs ending left of the lower run - including its diagonal neighbour
+		while( upper < upperEnd && upperRuns[upper].end < lowerRuns[lower].start )
+			upper++;
+		for( size_t u = upper; u < upperEnd && upperRuns[u].start <= lowerRuns[lower].end; u++ )
+			joinRuns( u, lower );
+	}
+}
+
+
+struct Band
+{
+	unsigned int startRow = 0;
+	unsigned int endRow = 0;
+	std::vector< Run > runs;
+	size_t firstRowEnd = 0;   // runs of the first row are [0,firstRowEnd)
+	size_t lastRowStart = 0;  // runs of the last row are [lastRowStart,runs.size())
+	std::vector< Area > areas;
+	std::vector< unsigned int > areaOfRun;
+
+	// the thresholded rows of the band and whether any bit of a row is set
+	std::vector< MaskWord > maskWords;
+	std::vector< uint8_t > rowSet;
+
+	void threshold( const PointIR::Frame & frame, const Unprojector::ScreenMask * mask, uint8_t threshold )
+	{
+		unsigned int wordsPerRow = ( frame.getWidth() + maskWordBits - 1 ) / maskWordBits;
+		this->maskWords.assign( ( this->endRow - this->startRow ) * wordsPerRow, 0 );
+		this->rowSet.resize( this->endRow - this->startRow );
+		for( unsigned int y = this->startRow; y < this->endRow; y++ )
+		{
+			MaskWord * words = this->maskWords.data() + ( y - this->startRow ) * wordsPerRow;
+			unsigned int start = mask ? (*mask)[y].start : 0;
+			unsigned int end = mask ? (*mask)[y].end : frame.getWidth();
+			thresholdRow( words, frame.getRow( y ), start, end, threshold );
+			MaskWord any = 0;
+			for( unsigned int w = 0; w < wordsPerRow; w++ )
+				any |= words[w];
+			this->rowSet[y - this->startRow] = any != 0;
+		}
+	}
+
+	void label( const PointIR::Frame & frame, const Unprojector::ScreenMask * mask, uint8_t threshold )
+	{
+		this->threshold( frame, mask, threshold );
+		unsigned int width = frame.getWidth();
+		unsigned int wordsPerRow = ( width + maskWordBits - 1 ) / maskWordBits;
+
+		this->runs.clear();
+		this->areas.clear();
+		size_t previousRowStart = 0;
+		for( unsigned int y = this->startRow; y < this->endRow; y++ )
+		{
+			size_t rowStart = this->runs.size();
+			if( this->rowSet[y - this->startRow] )
+			{
+				const MaskWord * words = this->maskWords.data() + ( y - this->startRow ) * wordsPerRow;
+				const uint8_t * row = frame.getRow( y );
+				unsigned int x = findBit( words, wordsPerRow, 0, true );
+				while( x < width )
+				{
+					Run run;
+					run.y = y;
+					run.start = x;
+					run.end = std::min( width, findBit( words, wordsPerRow, x, false ) );
+					run.peak = *std::max_element( row + run.start, row + run.end );
+					run.parent = this->runs.size();
+					this->runs.push_back( run );
+					x = findBit( words, wordsPerRow, run.end, true );
+				}
+			}
+			forTouchingRuns( this->runs, previousRowStart, rowStart, this->runs, rowStart, this->runs.size(),
+				[this] ( size_t upper, size_t lower ) { join( this->runs, upper, lower ); } );
+			if( y == this->startRow )
+				this->firstRowEnd = this->runs.size();
+			previousRowStart = rowStart;
+		}
+		this->lastRowStart = previousRowStart;
+
+		// roots come before the other runs of their area
+		this->areaOfRun.resize( this->runs.size() );
+		for( unsigned int i = 0; i < this->runs.size(); i++ )
+		{
+			unsigned int root = findRoot( this->runs, i );
+			if( root == i )
+			{
+				this->areaOfRun[i] = this->areas.size();
+				this->areas.push_back( Area() );
+			}
+			else
+			{
+				this->areaOfRun[i] = this->areaOfRun[root];
+			}
+			this->areas[this->areaOfRun[i]].add( this->runs[i] );
+		}
+	}
+};
+
+
+class Banded::Impl
+{
+public:
+	ThreadPool threadPool;
+	std::vector< Band > bands;
+	std::vector< Area > areas;
+
+	Impl( unsigned int threads ) : threadPool( threads )
+	{
+	}
+
+	void detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame,
+	             const Unprojector::ScreenMask * mask, uint8_t threshold, bool boundingFilterEnabled, float minBoundingSize, float maxBoundingSize )
+	{
+		unsigned int height = frame.getHeight();
+		unsigned int numBands = std::max( 1u, std::min( this->threadPool.getThreads(), height / minBandHeight ) );
+		this->bands.resize( numBands );
+		for( unsigned int b = 0; b < numBands; b++ )
+		{
+			this->bands[b].startRow = height * b / numBands;
+			this->bands[b].endRow = height * ( b + 1 ) / numBands;
+		}
+
+		this->threadPool.run( numBands, [&] ( unsigned int b ) { this->bands[b].label( frame, mask, threshold ); } );
+
+		// gather the areas of all bands and join those touching across a seam
+		std::vector< size_t > areaOffsets( numBands );
+		this->areas.clear();
+		for( unsigned int b = 0; b < numBands; b++ )
+		{
+			areaOffsets[b] = this->areas.size();
+			this->areas.insert( this->areas.end(), this->bands[b].areas.begin(), this->bands[b].areas.end() );
+		}
+		for( unsigned int i = 0; i < this->areas.size(); i++ )
+			this->areas[i].parent = i;
+		for( unsigned int b = 0; b + 1 < numBands; b++ )
+		{
+			const Band & upper = this->bands[b];
+			const Band & lower = this->bands[b+1];
+			forTouchingRuns( upper.runs, upper.lastRowStart, upper.runs.size(), lower.runs, 0, lower.firstRowEnd,
+				[&] ( size_t u, size_t l )
+				{
+					join( this->areas, areaOffsets[b] + upper.areaOfRun[u], areaOffsets[b+1] + lower.areaOfRun[l] );
+				} );
+		}
+
+		float averageImageSize = ( frame.getWidth() + frame.getHeight() ) / 2;
+		// minimum of one pixel for absolute point sizes
+		float minSize = std::max( 1.0f, minBoundingSize * averageImageSize );
+		float maxSize = std::max( 1.0f, maxBoundingSize * averageImageSize );
+		// box sizes are whole pixels - compare them with the limits rounded inwards
+		unsigned int minBoxSize = std::ceil( minSize );
+		unsigned int maxBoxSize = std::floor( maxSize );
+
+		// roots come before the other parts of their area, so each root is complete once the parts after it are added
+		for( unsigned int i = 0; i < this->areas.size(); i++ )
+		{
+			unsigned int root = findRoot( this->areas, i );
+			if( root != i )
+				this->areas[root].add( this->areas[i] );
+		}
+		pointArray.resizeIfNeeded( this->areas.size() );
+		blobs.resize( this->areas.size() );
+		size_t numPoints = 0;
+		for( unsigned int i = 0; i < this->areas.size(); i++ )
+		{
+			const Area & area = this->areas[i];
+			if( area.parent != i )
+				continue;
+			if( boundingFilterEnabled )
+			{
+				unsigned int boxSizeX = area.maxX - area.minX + 1;
+				unsigned int boxSizeY = area.maxY - area.minY + 1;
+				if( boxSizeX > maxBoxSize || boxSizeY > maxBoxSize || boxSizeX < minBoxSize || boxSizeY < minBoxSize )
+					continue;
+			}
+			area.toPoint( pointArray[numPoints], blobs[numPoints] );
+			numPoints++;
+		}
+		pointArray.resizeIfNeeded( numPoints );
+		blobs.resize( numPoints );
+	}
+};
+
+
+Banded::Banded( unsigned int threads ) : pImpl( new Impl( threads ) )
+{
+}
+
+
+Banded::~Banded()
+{
+}
+
+
+unsigned int Banded::getThreads() const
+{
+	return this->pImpl->threadPool.getThreads();
+}
+
+
+void Banded::detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame )
+{
+	this->pImpl->detect( pointArray, blobs, frame, nullptr,
+	                     this->intensityThreshold, this->boundingFilterEnabled, this->minBoundingSize, this->maxBoundingSize );
+}
+
+
+void Banded::detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame,
+                     const Unprojector::ScreenMask & mask )
+{
+	bool matching = mask.getWidth() == frame.getWidth() && mask.getHeight() == frame.getHeight();
+	this->pImpl->detect( pointArray, blobs, frame, matching ? &mask : nullptr,
+	                     this->intensityThreshold, this->boundingFilterEnabled, this->minBoundingSize, this->maxBoundingSize );
+}
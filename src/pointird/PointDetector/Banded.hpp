@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTDETECTOR_BANDED__INCLUDED_
+#define _POINTDETECTOR_BANDED__INCLUDED_
+
+
+#include "AThresholdDetector.hpp"
+
+#include <vector>
+#include <memory>
+
+
+namespace PointDetector
+{
+
+/**
+ * Splits the frame into horizontal bands which are searched for runs of bright pixels in parallel. Touching runs
+ * (including diagonally) are joined to areas - areas crossing the seams between bands are joined afterwards by
+ * comparing the last row of each band with the first row of the next one.
+ *
+ * Each band is thresholded into a mask of one bit per pixel first. Runs are found by searching the mask for set and
+ * cleared bits, which skips dark rows and whole words of dark pixels at once.
+ * The extents of each area are derived from its moments, so only the pixels of runs are visited again (for their peak).
+ */
+class Banded : public AThresholdDetector
+{
+public:
+	Banded( const Banded & ) = delete; // disable copy constructor
+	Banded & operator=( const Banded & other ) = delete; // disable assignment operator
+
+	/// Uses the given number of threads - 0 for one per hardware thread.
+	Banded( unsigned int threads = 0 );
+	~Banded();
+
+	virtual void detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame ) override;
+	virtual void detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame,
+	                     const Unprojector::ScreenMask & mask ) override;
+
+	unsigned int getThreads() const;
+
+private:
+	class Impl;
+	std::unique_ptr< Impl > pImpl;
+};
+
+}
+
+
+#endif
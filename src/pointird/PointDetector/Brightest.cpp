@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Brightest.hpp"
+#include "../Unprojector/ScreenMask.hpp"
+
+#include <PointIR/Frame.h>
+#include <PointIR/PointArray.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined __SSE2__
+	#include <emmintrin.h>
+#elif defined __ARM_NEON
+	#include <arm_neon.h>
+#endif
+
+
+using namespace PointDetector;
+
+
+// the brightest pixel in [start,end) of the row
+static uint8_t rowPeak( const uint8_t * row, unsigned int start, unsigned int end )
+{
+	uint8_t peak = 0;
+	unsigned int x = start;
+#ifdef __SSE2__
+	// 16 pixels at once, then reduce the lanes
+	__m128i peaks = _mm_setzero_si128();
+	for( ; x + 16 <= end; x += 16 )
+		peaks = _mm_max_epu8( peaks, _mm_loadu_si128( (const __m128i *)( row + x ) ) );
+	peaks = _mm_max_epu8( peaks, _mm_srli_si128( peaks, 8 ) );
+	peaks = _mm_max_epu8( peaks, _mm_srli_si128( peaks, 4 ) );
+	peaks = _mm_max_epu8( peaks, _mm_srli_si128( peaks, 2 ) );
+	peaks = _mm_max_epu8( peaks, _mm_srli_si128( peaks, 1 ) );
+	peak = _mm_cvtsi128_si32( peaks ) & 0xff;
+#elif defined __ARM_NEON
+	uint8x16_t peaks = vdupq_n_u8( 0 );
+	for( ; x + 16 <= end; x += 16 )
+		peaks = vmaxq_u8( peaks, vld1q_u8( row + x ) );
+	#ifdef __aarch64__
+	peak = vmaxvq_u8( peaks );
+	#else
+	uint8x8_t halves = vpmax_u8( vget_low_u8( peaks ), vget_high_u8( peaks ) );
+	halves = vpmax_u8( halves, halves );
+	halves = vpmax_u8( halves, halves );
+	halves = vpmax_u8( halves, halves );
+	peak = vget_lane_u8( halves, 0 );
+	#endif
+#endif
+	for( ; x < end; x++ )
+		peak = std::max( peak, row[x] );
+	return peak;
+}
+
+
+struct Spot
+{
+	double sumWeights = 0.0;
+	double sumX = 0.0;
+	double sumY = 0.0;
+	unsigned int count = 0;
+	unsigned int minX = 0;
+	unsigned int maxX = 0;
+	unsigned int minY = 0;
+	unsigned int maxY = 0;
+};
+
+
+// the weighted centroid of the pixels at or above the threshold within radius of x,y
+static Spot spotAround( const PointIR::Frame & frame, const Unprojector::ScreenMask * mask, unsigned int x, unsigned int y,
+                        unsigned int radius, uint8_t threshold )
+{
+	Spot spot;
+	unsigned int startY = y > radius ? y - radius : 0;
+	unsigned int endY = std::min( frame.getHeight(), y + radius + 1 );
+	for( unsigned int windowY = startY; windowY < endY; windowY++ )
+	{
+		unsigned int startX = x > radius ? x - radius : 0;
+		unsigned int endX = std::min( frame.getWidth(), x + radius + 1 );
+		if( mask )
+		{
+			startX = std::max( startX, (*mask)[windowY].start );
+			endX = std::min( endX, (*mask)[windowY].end );
+		}
+		const uint8_t * row = frame.getRow( windowY );
+		for( unsigned int windowX = startX; windowX < endX; windowX++ )
+		{
+			if( row[windowX] < threshold )
+				continue;
+			double weight = row[windowX] - threshold + 1;
+			spot.sumWeights += weight;
+			spot.sumX += weight * windowX;
+			spot.sumY += weight * windowY;
+			if( !spot.count )
+			{
+				spot.minX = spot.maxX = windowX;
+				spot.minY = spot.maxY = windowY;
+			}
+			spot.minX = std::min( spot.minX, windowX );
+			spot.maxX = std::max( spot.maxX, windowX );
+			spot.minY = std::min( spot.minY, windowY );
+			spot.maxY = std::max( spot.maxY, windowY );
+			spot.count++;
+		}
+	}
+	return spot;
+}
+
+
+// moves x (or y) to the middle of the pixels at or above the threshold around it in its row (or column) and returns their number
+static unsigned int brightRun( const PointIR::Frame & frame, const Unprojector::ScreenMask * mask, unsigned int & x, unsigned int & y,
+                               uint8_t threshold, bool horizontal )
+{
+	unsigned int & position = horizontal ? x : y;
+	unsigned int limit = horizontal ? frame.getWidth() : frame.getHeight();
+	auto bright = [&] ( unsigned int p )
+	{
+		unsigned int px = horizontal ? p : x;
+		unsigned int py = horizontal ? y : p;
+		if( mask && ( px < (*mask)[py].start || px >= (*mask)[py].end ) )
+			return false;
+		return frame.getRow( py )[px] >= threshold;
+	};
+	if( !bright( position ) )
+		return 0;
+	unsigned int first = position;
+	while( first > 0 && bright( first - 1 ) )
+		first--;
+	unsigned int last = position;
+	while( last + 1 < limit && bright( last + 1 ) )
+		last++;
+	position = ( first + last ) / 2;
+	return last - first + 1;
+}
+
+
+static void detectBrightest( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame,
+                             const Unprojector::ScreenMask * mask, uint8_t threshold, unsigned int radius,
+                             bool boundingFilterEnabled, float minBoundingSize, float maxBoundingSize )
+{
+	pointArray.resizeIfNeeded( 0 );
+	blobs.clear();
+
+	// the first of the brightest pixels
+	uint8_t peak = 0;
+	unsigned int peakX = 0;
+	unsigned int peakY = 0;
+	for( unsigned int y = 0; y < frame.getHeight(); y++ )
+	{
+		unsigned int start = mask ? (*mask)[y].start : 0;
+		unsigned int end = mask ? (*mask)[y].end : frame.getWidth();
+		const uint8_t * row = frame.getRow( y );
+		uint8_t rowMax = rowPeak( row, start, end );
+		if( rowMax > peak )
+		{
+			peak = rowMax;
+			peakX = std::find( row + start, row + end, rowMax ) - row;
+			peakY = y;
+		}
+	}
+	if( peak < threshold )
+		return;
+
+	// center the window on the spot - the peak is its first brightest pixel, which may lie at its edge when it is
+	// saturated - and enlarge it to cover the spot
+	unsigned int x = peakX;
+	unsigned int y = peakY;
+	unsigned int extentX = brightRun( frame, mask, x, y, threshold, true );
+	unsigned int extentY = brightRun( frame, mask, x, y, threshold, false );
+	extentX = std::max( extentX, brightRun( frame, mask, x, y, threshold, true ) );
+	Spot spot = spotAround( frame, mask, x, y, std::max( radius, std::max( extentX, extentY ) / 2 + 1 ), threshold );
+
+	unsigned int boxSizeX = spot.maxX - spot.minX + 1;
+	unsigned int boxSizeY = spot.maxY - spot.minY + 1;
+	if( boundingFilterEnabled )
+	{
+		float averageImageSize = ( frame.getWidth() + frame.getHeight() ) / 2;
+		// minimum of one pixel for absolute point sizes
+		float minSize = std::max( 1.0f, minBoundingSize * averageImageSize );
+		float maxSize = std::max( 1.0f, maxBoundingSize * averageImageSize );
+		// box sizes are whole pixels - compare them with the limits rounded inwards
+		unsigned int minBoxSize = std::ceil( minSize );
+		unsigned int maxBoxSize = std::floor( maxSize );
+		if( boxSizeX > maxBoxSize || boxSizeY > maxBoxSize || boxSizeX < minBoxSize || boxSizeY < minBoxSize )
+			return;
+	}
+
+	pointArray.resizeIfNeeded( 1 );
+	pointArray[0].x = spot.sumX / spot.sumWeights;
+	pointArray[0].y = spot.sumY / spot.sumWeights;
+	blobs.push_back( PointIR::Blob( (float)boxSizeX, (float)boxSizeY, (float)spot.count, 0.0f, peak / 255.0f ) );
+}
+
+
+void Brightest::detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame )
+{
+	detectBrightest( pointArray, blobs, frame, nullptr, this->intensityThreshold, this->windowRadius,
+	                 this->boundingFilterEnabled, this->minBoundingSize, this->maxBoundingSize );
+}
+
+
+void Brightest::detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame,
+                        const Unprojector::ScreenMask & mask )
+{
+	bool matching = mask.getWidth() == frame.getWidth() && mask.getHeight() == frame.getHeight();
+	detectBrightest( pointArray, blobs, frame, matching ? &mask : nullptr, this->intensityThreshold, this->windowRadius,
+	                 this->boundingFilterEnabled, this->minBoundingSize, this->maxBoundingSize );
+}
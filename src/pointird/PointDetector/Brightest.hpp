@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTDETECTOR_BRIGHTEST__INCLUDED_
+#define _POINTDETECTOR_BRIGHTEST__INCLUDED_
+
+
+#include "AThresholdDetector.hpp"
+
+#include <vector>
+#include <atomic>
+
+
+namespace PointDetector
+{
+
+/**
+ * Finds at most one point - the brightest spot of the frame, for setups with a single laser pointer or pen.
+ *
+ * The frame is scanned once for its brightest pixel. If that is at or above the threshold, the point is the centroid of
+ * the pixels at or above the threshold within a window around the spot, weighted by how far they exceed the threshold.
+ * The window is centered on the middle of the bright pixels in the row and column of the brightest one and grows with
+ * the spot, so saturated spots are not biased towards the pixel found first.
+ */
+class Brightest : public AThresholdDetector
+{
+public:
+	virtual void detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame ) override;
+	virtual void detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame,
+	                     const Unprojector::ScreenMask & mask ) override;
+
+	/// Pixels farther than this from the brightest one (in both directions) are not part of the spot.
+	void setWindowRadius( unsigned int radius ) { this->windowRadius = radius; }
+	unsigned int getWindowRadius() const { return this->windowRadius; }
+
+private:
+	std::atomic< unsigned int > windowRadius { 8 };
+};
+
+}
+
+
+#endif
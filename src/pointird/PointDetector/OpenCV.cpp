@@ -21,12 +21,15 @@
 
 
 #include "OpenCV.hpp"
+#include "../Unprojector/ScreenMask.hpp"
 
 #include <PointIR/Frame.h>
 #include <PointIR/PointArray.h>
 
 #include <iostream>
 #include <limits>
+#include <algorithm>
+#include <cmath>
 
 #include <assert.h>
 
@@ -43,10 +46,10 @@ using namespace PointDetector;
 
 struct BoundingBox
 {
-	float minX = std::numeric_limits< float >::max();
-	float minY = std::numeric_limits< float >::max();
-	float maxX = std::numeric_limits< float >::min();
-	float maxY = std::numeric_limits< float >::min();
+	int minX = std::numeric_limits< int >::max();
+	int minY = std::numeric_limits< int >::max();
+	int maxX = std::numeric_limits< int >::min();
+	int maxY = std::numeric_limits< int >::min();
 };
 
 
@@ -55,22 +58,62 @@ static cv::Mat imageDebug;
 #endif
 
 
-static void pointsFromContours( PointIR::PointArray & pointArray, const std::vector< std::vector<cv::Point> > & contours )
+// the area of a contour excludes half of its outline pixels - add them back to get the number of covered pixels
+static float contourPixelArea( const std::vector<cv::Point> & contour )
+{
+	return cv::contourArea( contour ) + cv::arcLength( contour, true ) / 2.0f + 1.0f;
+}
+
+
+// the brightest pixel within the bounding box of the contour
+static float peakIntensity( const std::vector<cv::Point> & contour, const PointIR::Frame & frame )
+{
+	cv::Rect box = cv::boundingRect( contour );
+	uint8_t peak = 0;
+	for( int y = box.y; y < box.y + box.height; y++ )
+	{
+		const uint8_t * row = frame.getRow( y );
+		for( int x = box.x; x < box.x + box.width; x++ )
+			peak = std::max( peak, row[x] );
+	}
+	return peak / 255.0f;
+}
+
+
+// the extents of the smallest rotated rectangle enclosing the contour - contours run through pixel centers, so add one pixel to each side
+static PointIR::Blob blobFromContour( const std::vector<cv::Point> & contour, const PointIR::Frame & frame )
+{
+	const float pi = 3.14159265358979f;
+	cv::RotatedRect rect = cv::minAreaRect( contour );
+	float angle = rect.angle * pi / 180.0f;
+	while( angle < 0.0f )
+		angle += pi;
+	while( angle >= pi )
+		angle -= pi;
+	return PointIR::Blob( rect.size.width + 1.0f, rect.size.height + 1.0f, contourPixelArea( contour ), angle, peakIntensity( contour, frame ) );
+}
+
+
+static void pointsFromContours( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs,
+                                const std::vector< std::vector<cv::Point> > & contours, const PointIR::Frame & frame )
 {
 	pointArray.resizeIfNeeded( contours.size() );
+	blobs.resize( contours.size() );
 	for( size_t i = 0 ; i < contours.size() ; i++ )
 	{
-		PointIR_Point & point = pointArray[i];
-		point.x = 0;
-		point.y = 0;
+		// contour points are whole pixels - sum them exactly and divide once
+		long sumX = 0;
+		long sumY = 0;
 		assert( !contours[i].empty() );
 		for( const cv::Point & contourPoint : contours[i] )
 		{
-			point.x += contourPoint.x;
-			point.y += contourPoint.y;
+			sumX += contourPoint.x;
+			sumY += contourPoint.y;
 		}
-		point.x /= contours[i].size();
-		point.y /= contours[i].size();
+		PointIR_Point & point = pointArray[i];
+		point.x = (float)sumX / contours[i].size();
+		point.y = (float)sumY / contours[i].size();
+		blobs[i] = blobFromContour( contours[i], frame );
 #ifdef _POINTDETECTOR_OPENCV__LIVEDEBUG_
 		cv::circle( imageDebug, cv::Point2f( point.x, point.y ), 3.0f, cv::Scalar( 0, 255, 0 ) );
 #endif
@@ -78,21 +121,26 @@ static void pointsFromContours( PointIR::PointArray & pointArray, const std::vec
 }
 
 
-static void pointsFromContours_BoundFiltered( PointIR::PointArray & pointArray, const std::vector< std::vector<cv::Point> > & contours,
+static void pointsFromContours_BoundFiltered( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs,
+                                              const std::vector< std::vector<cv::Point> > & contours, const PointIR::Frame & frame,
                                               const float & minSize, const float & maxSize )
 {
 	pointArray.resizeIfNeeded( contours.size() );
+	blobs.resize( contours.size() );
+	// box sizes are whole pixels - compare them with the limits rounded inwards
+	int minBoxSize = std::ceil( minSize );
+	int maxBoxSize = std::floor( maxSize );
+	size_t numPoints = 0;
 	for( size_t i = 0 ; i < contours.size() ; i++ )
 	{
 		BoundingBox box;
-		PointIR_Point & point = pointArray[i];
-		point.x = 0;
-		point.y = 0;
+		long sumX = 0;
+		long sumY = 0;
 		assert( !contours[i].empty() );
 		for( const cv::Point & contourPoint : contours[i] )
 		{
-			point.x += contourPoint.x;
-			point.y += contourPoint.y;
+			sumX += contourPoint.x;
+			sumY += contourPoint.y;
 			if( contourPoint.x > box.maxX )
 				box.maxX = contourPoint.x;
 			if( contourPoint.y > box.maxY )
@@ -103,38 +151,34 @@ static void pointsFromContours_BoundFiltered( PointIR::PointArray & pointArray,
 				box.minY = contourPoint.y;
 		}
 #ifdef _POINTDETECTOR_OPENCV__LIVEDEBUG_
-		cv::circle( imageDebug, cv::Point2f( point.x/contours[i].size(), point.y/contours[i].size() ), 3.0f, cv::Scalar( 0, 64, 0 ) );
+		cv::circle( imageDebug, cv::Point2f( (float)sumX/contours[i].size(), (float)sumY/contours[i].size() ), 3.0f, cv::Scalar( 0, 64, 0 ) );
 		cv::rectangle( imageDebug, cv::Point2f( box.minX, box.minY ), cv::Point2f( box.maxX, box.maxY ), cv::Scalar( 0, 64, 64 ) );
 #endif
-		float boxSizeX = box.maxX - box.minX + 1.0f;
-		float boxSizeY = box.maxY - box.minY + 1.0f;
-		if( boxSizeX > maxSize || boxSizeY > maxSize || boxSizeX < minSize || boxSizeY < minSize )
+		int boxSizeX = box.maxX - box.minX + 1;
+		int boxSizeY = box.maxY - box.minY + 1;
+		if( boxSizeX > maxBoxSize || boxSizeY > maxBoxSize || boxSizeX < minBoxSize || boxSizeY < minBoxSize )
 			continue;
-		point.x /= contours[i].size();
-		point.y /= contours[i].size();
+		PointIR_Point & point = pointArray[numPoints];
+		point.x = (float)sumX / contours[i].size();
+		point.y = (float)sumY / contours[i].size();
+		blobs[numPoints] = blobFromContour( contours[i], frame );
+		numPoints++;
 #ifdef _POINTDETECTOR_OPENCV__LIVEDEBUG_
 		cv::circle( imageDebug, cv::Point2f( point.x, point.y ), 3.0f, cv::Scalar( 0, 255, 0 ) );
 		cv::rectangle( imageDebug, cv::Point2f( box.minX, box.minY ), cv::Point2f( box.maxX, box.maxY ), cv::Scalar( 0, 255, 255 ) );
 #endif
 	}
+	// drop the slots of filtered contours
+	pointArray.resizeIfNeeded( numPoints );
+	blobs.resize( numPoints );
 }
 
 
-void OpenCV::detect( PointIR::PointArray & pointArray, const PointIR::Frame & frame )
+// finds the points in the thresholded image, which is modified
+static void pointsFromThresholded( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs,
+                                   cv::Mat & imageThresholded, const PointIR::Frame & frame,
+                                   bool boundingFilterEnabled, float minBoundingSize, float maxBoundingSize )
 {
-	// create a thresholded copy of input image that may be modified
-	cv::Mat imageThresholded( cv::Size( frame.getWidth(), frame.getHeight()), CV_8UC1 );
-	assert( imageThresholded.isContinuous() );
-
-	size_t imageSize = frame.size();
-	for( size_t wh = 0 ; wh < imageSize ; wh++ )
-	{
-		if( frame[wh] >= this->intensityThreshold )
-			imageThresholded.data[wh] = 0xff;
-		else
-			imageThresholded.data[wh] = 0x00;
-	}
-
 //	cv::morphologyEx( imageThresholded, imageThresholded, cv::MORPH_OPEN, cv::Mat(), cv::Point(-1,-1), 5 );
 
 #ifdef _POINTDETECTOR_OPENCV__LIVEDEBUG_
@@ -155,13 +199,13 @@ void OpenCV::detect( PointIR::PointArray & pointArray, const PointIR::Frame & fr
 	{
 		float averageImageSize = (frame.getWidth()+frame.getHeight())/2;
 		// minimum of one pixel for absolute point sizes
-		float minSize = std::max( 1.0f, this->minBoundingSize * averageImageSize );
-		float maxSize = std::max( 1.0f, this->maxBoundingSize * averageImageSize );
-		pointsFromContours_BoundFiltered( pointArray, contours, minSize, maxSize );
+		float minSize = std::max( 1.0f, minBoundingSize * averageImageSize );
+		float maxSize = std::max( 1.0f, maxBoundingSize * averageImageSize );
+		pointsFromContours_BoundFiltered( pointArray, blobs, contours, frame, minSize, maxSize );
 	}
 	else
 	{
-		pointsFromContours( pointArray, contours );
+		pointsFromContours( pointArray, blobs, contours, frame );
 	}
 
 #ifdef _POINTDETECTOR_OPENCV__LIVEDEBUG_
@@ -169,3 +213,51 @@ void OpenCV::detect( PointIR::PointArray & pointArray, const PointIR::Frame & fr
 	cv::waitKey(1); // need this for event processing - window wouldn't be visible
 #endif
 }
+
+
+void OpenCV::detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame )
+{
+	// create a thresholded copy of input image that may be modified
+	cv::Mat imageThresholded( cv::Size( frame.getWidth(), frame.getHeight()), CV_8UC1 );
+	assert( imageThresholded.isContinuous() );
+
+	uint8_t intensityThreshold = this->intensityThreshold;
+	for( unsigned int y = 0; y < frame.getHeight(); y++ )
+	{
+		const uint8_t * src = frame.getRow( y );
+		uint8_t * dst = imageThresholded.data + y * frame.getWidth();
+		for( unsigned int x = 0; x < frame.getWidth(); x++ )
+			dst[x] = ( src[x] >= intensityThreshold ) ? 0xff : 0x00;
+	}
+
+	pointsFromThresholded( pointArray, blobs, imageThresholded, frame,
+	                       this->boundingFilterEnabled, this->minBoundingSize, this->maxBoundingSize );
+}
+
+
+void OpenCV::detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame,
+                     const Unprojector::ScreenMask & mask )
+{
+	if( mask.getWidth() != frame.getWidth() || mask.getHeight() != frame.getHeight() )
+	{
+		this->detect( pointArray, blobs, frame );
+		return;
+	}
+
+	// everything outside of the mask stays dark - only the covered spans are thresholded
+	cv::Mat imageThresholded = cv::Mat::zeros( cv::Size( frame.getWidth(), frame.getHeight()), CV_8UC1 );
+	assert( imageThresholded.isContinuous() );
+
+	uint8_t intensityThreshold = this->intensityThreshold;
+	for( unsigned int y = 0; y < frame.getHeight(); y++ )
+	{
+		const Unprojector::ScreenMask::Span & span = mask[y];
+		const uint8_t * src = frame.getRow( y );
+		uint8_t * dst = imageThresholded.data + y * frame.getWidth();
+		for( unsigned int x = span.start; x < span.end; x++ )
+			dst[x] = ( src[x] >= intensityThreshold ) ? 0xff : 0x00;
+	}
+
+	pointsFromThresholded( pointArray, blobs, imageThresholded, frame,
+	                       this->boundingFilterEnabled, this->minBoundingSize, this->maxBoundingSize );
+}
@@ -21,36 +21,21 @@
 #define _POINTDETECTOR_OPENCV__INCLUDED_
 
 
-#include "APointDetector.hpp"
+#include "AThresholdDetector.hpp"
 
 #include <vector>
 
-#include <stdint.h>
-
 
 namespace PointDetector
 {
 
-class OpenCV : public APointDetector
+/// Finds the outer contours of the thresholded frame.
+class OpenCV : public AThresholdDetector
 {
 public:
-	virtual void detect( PointIR::PointArray & pointArray, const PointIR::Frame & frame ) override;
-
-	void setIntensityThreshold( uint8_t threshold ) { this->intensityThreshold = threshold; }
-	uint8_t getIntensityThreshold() const { return this->intensityThreshold; }
-
-	void setBoundingFilterEnabled( bool enable ) { this->boundingFilterEnabled = enable; }
-	bool isBoundingFilterEnabled() const { return this->boundingFilterEnabled; }
-	void setMinBoundingSize( const float & minBoundingSize ) { this->minBoundingSize = minBoundingSize; }
-	void setMaxBoundingSize( const float & maxBoundingSize ) { this->maxBoundingSize = maxBoundingSize; }
-	const float & getMinBoundingSize() const { return this->minBoundingSize; }
-	const float & getMaxBoundingSize() const { return this->maxBoundingSize; }
-
-private:
-	uint8_t intensityThreshold = 127;
-	bool boundingFilterEnabled = false;
-	float minBoundingSize = 0.0002f;
-	float maxBoundingSize = 0.125f;
+	virtual void detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame ) override;
+	virtual void detect( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, const PointIR::Frame & frame,
+	                     const Unprojector::ScreenMask & mask ) override;
 };
 
 }
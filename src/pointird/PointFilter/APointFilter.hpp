@@ -21,13 +21,11 @@
 #define _APOINTFILTER__INCLUDED_
 
 
-#include <vector>
+#include "../PointBatch.hpp"
 
+#include <PointIR/Blob.h>
 
-namespace PointIR
-{
-	class PointArray;
-}
+#include <vector>
 
 
 namespace PointFilter
@@ -36,7 +34,8 @@ namespace PointFilter
 class APointFilter
 {
 public:
-	virtual void filterPoints( PointIR::PointArray & pointArray ) const = 0;
+	/// The blobs have to be kept in the same order as the points - so do all columns of the batch.
+	virtual void filterPoints( PointBatch & batch, std::vector< PointIR::Blob > & blobs ) const = 0;
 };
 
 }
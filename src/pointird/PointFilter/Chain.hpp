@@ -55,10 +55,10 @@ public:
 		return this->filterChain;
 	}
 
-	virtual void filterPoints( PointIR::PointArray & pointArray ) const override
+	virtual void filterPoints( PointBatch & batch, std::vector< PointIR::Blob > & blobs ) const override
 	{
 		for( const APointFilter * filter : this->filterChain )
-			filter->filterPoints( pointArray );
+			filter->filterPoints( batch, blobs );
 	}
 
 private:
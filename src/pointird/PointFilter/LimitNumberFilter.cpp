@@ -19,18 +19,17 @@
 
 #include "LimitNumberFilter.hpp"
 
-#include <PointIR/PointArray.h>
-
 #include <iostream>
 
 
 using namespace PointFilter;
 
 
-void LimitNumberFilter::filterPoints( PointIR::PointArray & pointArray ) const
+void LimitNumberFilter::filterPoints( PointBatch & batch, std::vector< PointIR::Blob > & blobs ) const
 {
-	if( pointArray.size() > this->limit )
+	if( batch.getCount() > this->limit )
 	{
-		pointArray.resize( this->limit );
+		batch.resize( this->limit );
+		blobs.resize( this->limit );
 	}
 }
@@ -32,7 +32,7 @@ namespace PointFilter
 class LimitNumberFilter : public APointFilter
 {
 public:
-	virtual void filterPoints( PointIR::PointArray & pointArray ) const override;
+	virtual void filterPoints( PointBatch & batch, std::vector< PointIR::Blob > & blobs ) const override;
 
 	void setLimit( unsigned int limit ) { this->limit = limit; }
 	unsigned int getLimit() const { return this->limit; }
@@ -19,29 +19,64 @@
 
 #include "OffscreenFilter.hpp"
 
-#include <PointIR/PointArray.h>
+#include <limits>
+
+#include <stdint.h>
+#include <string.h>
 
 
 using namespace PointFilter;
 
 
-template< typename T >
-static void erase_unordered( T & v, size_t index )
+#ifdef POINTIR_FIXEDPOINT
+// maps finite floats to integers of the same order, so they can be compared without a floating point unit
+static int32_t orderedBits( float value )
 {
-	std::swap( v[index], v.back() );
-	v.pop_back();
+	int32_t bits;
+	memcpy( &bits, &value, sizeof(bits) );
+	// negative floats are sign and magnitude
+	return bits < 0 ? std::numeric_limits< int32_t >::min() - bits : bits;
 }
+#endif
 
 
-void OffscreenFilter::filterPoints( PointIR::PointArray & pointArray ) const
+void OffscreenFilter::filterPoints( PointBatch & batch, std::vector< PointIR::Blob > & blobs ) const
 {
 	float minMargin = 0.0f - this->tolerance;
 	float maxMargin = 1.0f + this->tolerance;
-	for( PointIR::PointArray::size_type i = 0; i < pointArray.size(); )
+#ifdef POINTIR_FIXEDPOINT
+	int32_t minBits = orderedBits( minMargin );
+	int32_t maxBits = orderedBits( maxMargin );
+	auto offscreen = [minBits,maxBits]( float pointX, float pointY )
+	{
+		int32_t x = orderedBits( pointX );
+		int32_t y = orderedBits( pointY );
+		return x < minBits || x >= maxBits || y < minBits || y >= maxBits;
+	};
+#else
+	auto offscreen = [minMargin,maxMargin]( float pointX, float pointY )
+	{
+		return pointX < minMargin || pointX >= maxMargin || pointY < minMargin || pointY >= maxMargin;
+	};
+#endif
+
+	// the tests only read the coordinate columns
+	const float * x = batch.x.data();
+	const float * y = batch.y.data();
+	size_t count = batch.getCount();
+	size_t kept = 0;
+	while( kept < count && !offscreen( x[kept], y[kept] ) )
+		kept++;
+
+	// move the remaining points and their blobs to the front, keeping their order
+	for( size_t i = kept; i < count; i++ )
 	{
-		if( pointArray[i].x < minMargin || pointArray[i].x >= maxMargin || pointArray[i].y < minMargin || pointArray[i].y >= maxMargin )
-			erase_unordered( pointArray, i );
-		else
-			i++;
+		if( offscreen( x[i], y[i] ) )
+			continue;
+		batch.copyPoint( kept, i );
+		blobs[kept] = blobs[i];
+		kept++;
 	}
+	batch.resize( kept );
+	blobs.resize( kept );
 }
@@ -32,7 +32,7 @@ namespace PointFilter
 class OffscreenFilter : public APointFilter
 {
 public:
-	virtual void filterPoints( PointIR::PointArray & pointArray ) const override;
+	virtual void filterPoints( PointBatch & batch, std::vector< PointIR::Blob > & blobs ) const override;
 
 	void setTolerance( float tolerance ) { this->tolerance = tolerance; }
 	float getTolerance() const { return this->tolerance; }
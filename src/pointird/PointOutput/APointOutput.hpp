@@ -21,6 +21,8 @@
 #define _APOINTOUTPUT__INCLUDED_
 
 
+#include <PointIR/Blob.h>
+
 #include <vector>
 
 
@@ -29,6 +31,11 @@ namespace PointIR
 	class PointArray;
 }
 
+namespace Tracker
+{
+	class TrackedPoints;
+}
+
 
 namespace PointOutput
 {
@@ -37,7 +44,9 @@ class APointOutput
 {
 public:
 	virtual ~APointOutput() {}
-	virtual void outputPoints( const PointIR::PointArray & pointArray ) = 0;
+	/// The blobs hold the extents of each point - in the same order as the points. The tracked points hold their IDs and motion.
+	virtual void outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+	                           const Tracker::TrackedPoints & trackedPoints ) = 0;
 };
 
 }
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Async.hpp"
+#include "../Tracker/TrackedPoints.hpp"
+
+#include <PointIR/PointArray.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include <utility>
+
+
+using namespace PointOutput;
+
+
+class Async::Impl
+{
+public:
+	struct Slot
+	{
+		PointIR::PointArray pointArray;
+		std::vector< PointIR::Blob > blobs;
+		Tracker::TrackedPoints trackedPoints;
+	};
+
+	// the newest points not yet taken by the worker - older ones are dropped, but their tracking is kept
+	std::mutex mutex;
+	std::condition_variable condition;
+	Slot mailbox;
+	bool hasPoints = false;
+	bool stop = false;
+	unsigned long droppedFrames = 0;
+
+	std::thread worker;
+
+	void run( APointOutput & output );
+};
+
+
+void Async::Impl::run( APointOutput & output )
+{
+	Slot slot;
+	while( true )
+	{
+		{
+			std::unique_lock< std::mutex > lock( this->mutex );
+			this->condition.wait( lock, [this] { return this->hasPoints || this->stop; } );
+			if( this->stop )
+				return;
+			// the worker's previous slot becomes the next mailbox - its buffers are reused
+			std::swap( slot, this->mailbox );
+			this->hasPoints = false;
+		}
+
+		try
+		{
+			output.outputPoints( slot.pointArray, slot.blobs, slot.trackedPoints );
+		}
+		catch( std::exception & ex )
+		{
+			std::cerr << std::string(__PRETTY_FUNCTION__) << std::string(": ignoring exception: ") << ex.what() << "\n";
+		}
+	}
+}
+
+
+Async::Async( APointOutput * output ) :
+	output( output ), pImpl( new Impl )
+{
+	this->pImpl->worker = std::thread( &Impl::run, this->pImpl.get(), std::ref( *this->output ) );
+}
+
+
+Async::~Async()
+{
+	{
+		std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+		this->pImpl->stop = true;
+	}
+	this->pImpl->condition.notify_one();
+	this->pImpl->worker.join();
+}
+
+
+void Async::outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+                          const Tracker::TrackedPoints & trackedPoints )
+{
+	{
+		std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+		if( this->pImpl->hasPoints )
+			this->pImpl->droppedFrames++;
+		this->pImpl->mailbox.pointArray = pointArray;
+		this->pImpl->mailbox.blobs = blobs;
+		// the output still has to see the contacts lifted in the dropped frames
+		if( this->pImpl->hasPoints )
+			this->pImpl->mailbox.trackedPoints.append( trackedPoints );
+		else
+			this->pImpl->mailbox.trackedPoints = trackedPoints;
+		this->pImpl->hasPoints = true;
+	}
+	this->pImpl->condition.notify_one();
+}
+
+
+unsigned long Async::getDroppedFrames() const
+{
+	std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+	return this->pImpl->droppedFrames;
+}
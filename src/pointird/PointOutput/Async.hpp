@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTOUTPUT_ASYNC__INCLUDED_
+#define _POINTOUTPUT_ASYNC__INCLUDED_
+
+
+#include "APointOutput.hpp"
+
+#include <memory>
+
+
+namespace PointOutput
+{
+
+/**
+ * Runs another point output on its own worker thread.
+ *
+ * The points are copied into a mailbox holding only the newest frame. The tracking of frames dropped from it is
+ * merged into the next one, so the output still learns about contacts lifted in between.
+ */
+class Async : public APointOutput
+{
+public:
+	Async( const Async & ) = delete; // disable copy constructor
+	Async & operator=( const Async & other ) = delete; // disable assignment operator
+
+	/// Takes ownership of the given output.
+	Async( APointOutput * output );
+	virtual ~Async();
+
+	virtual void outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+	                           const Tracker::TrackedPoints & trackedPoints ) override;
+
+	APointOutput * getOutput() const { return this->output.get(); }
+	/// Number of frames merged into a later one before the worker took them.
+	unsigned long getDroppedFrames() const;
+
+private:
+	std::unique_ptr< APointOutput > output;
+
+	class Impl;
+	std::unique_ptr< Impl > pImpl;
+};
+
+}
+
+
+#endif
@@ -27,6 +27,8 @@
 #include <opencv2/imgproc/imgproc.hpp>
 
 #include <iostream>
+#include <cmath>
+#include <algorithm>
 
 
 using namespace PointOutput;
@@ -42,25 +44,45 @@ DebugOpenCV::~DebugOpenCV()
 }
 
 
-void DebugOpenCV::outputPoints( const PointIR::PointArray & pointArray )
+void DebugOpenCV::outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+                                const Tracker::TrackedPoints & )
 {
 	cv::Mat image;
-	const PointIR_Frame * frame = this->processor.getProcessedFrame();
-	if( (!frame->width) || (!frame->height) )
+	const PointIR::Frame & frame = this->processor.getProcessedFrame();
+	if( frame.empty() )
 	{
 		image = cv::Mat( cv::Size( 256, 256 ), CV_8UC1 );
 		assert( image.isContinuous() );
 	}
 	else
 	{
-		image = cv::Mat( cv::Size( frame->width, frame->height ), CV_8UC1 );
+		// the calibration refers to the whole image - the frame may only show a part of it
+		unsigned int width = std::max( frame.getWidth(), this->processor.getFullFrameWidth() );
+		unsigned int height = std::max( frame.getHeight(), this->processor.getFullFrameHeight() );
+		unsigned int x = std::min( this->processor.getFrameX(), width - frame.getWidth() );
+		unsigned int y = std::min( this->processor.getFrameY(), height - frame.getHeight() );
+		image = cv::Mat( cv::Size( width, height ), CV_8UC1, cv::Scalar( 0 ) );
 		assert( image.isContinuous() );
-		memcpy( image.data, frame->data, frame->width * frame->height );
-		processor.getUnprojector().unproject( image.data, frame->width, frame->height );
+		for( unsigned int row = 0; row < frame.getHeight(); row++ )
+			memcpy( image.data + ( y + row ) * width + x, frame.getRow( row ), frame.getWidth() );
+		processor.getUnprojector().unproject( image.data, width, height );
 	}
 	cv::cvtColor( image, image, CV_GRAY2RGB );
-	for( const PointIR_Point & point : pointArray )
+	for( PointIR::PointArray::size_type i = 0; i < pointArray.size(); i++ )
+	{
+		const PointIR_Point & point = pointArray[i];
 		cv::circle( image, cv::Point2f( point.x * image.cols, point.y * image.rows ), 10.0f, cv::Scalar( 0, 255, 0 ) );
+		const PointIR::Blob & blob = blobs[i];
+		cv::Point2f center( point.x * image.cols, point.y * image.rows );
+		cv::Point2f widthAxis( std::cos( blob.angle ) * blob.width * image.cols / 2.0f, std::sin( blob.angle ) * blob.width * image.rows / 2.0f );
+		cv::Point2f heightAxis( -std::sin( blob.angle ) * blob.height * image.cols / 2.0f, std::cos( blob.angle ) * blob.height * image.rows / 2.0f );
+		cv::Point2f corners[4] = {
+			center - widthAxis - heightAxis, center + widthAxis - heightAxis,
+			center + widthAxis + heightAxis, center - widthAxis + heightAxis
+		};
+		for( int c = 0; c < 4; c++ )
+			cv::line( image, corners[c], corners[(c+1)%4], cv::Scalar( 0, 255, 255 ) );
+	}
 	cv::imshow( "DebugPointOutputCV", image );
 	cv::waitKey(1); // need this for event processing - window wouldn't be visible
 }
@@ -39,7 +39,8 @@ public:
 	DebugOpenCV( const Processor & processor );
 	virtual ~DebugOpenCV();
 
-	virtual void outputPoints( const PointIR::PointArray & pointArray ) override;
+	virtual void outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+	                           const Tracker::TrackedPoints & trackedPoints ) override;
 
 private:
 	const Processor & processor;
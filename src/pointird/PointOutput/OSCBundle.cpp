@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OSCBundle.hpp"
+
+#include <chrono>
+#include <cstring>
+
+
+using namespace PointOutput;
+
+
+// seconds between the NTP epoch (1900) and the unix epoch (1970)
+static const uint64_t ntpUnixOffset = 2208988800ULL;
+
+
+OSCBundle::OSCBundle( size_t reserve ) :
+	buffer( reserve )
+{
+}
+
+
+void OSCBundle::reserve( size_t bytes )
+{
+	if( this->used + bytes <= this->buffer.size() )
+		return;
+	size_t newSize = this->buffer.size() ? this->buffer.size() : 64;
+	while( newSize < this->used + bytes )
+		newSize *= 2;
+	this->buffer.resize( newSize );
+}
+
+
+void OSCBundle::appendUInt32( uint32_t value )
+{
+	this->reserve( 4 );
+	uint8_t * p = this->buffer.data() + this->used;
+	p[0] = value >> 24;
+	p[1] = value >> 16;
+	p[2] = value >> 8;
+	p[3] = value;
+	this->used += 4;
+}
+
+
+void OSCBundle::appendPadded( const char * string )
+{
+	size_t length = strlen( string );
+	size_t padded = ( length + 4 ) & ~size_t(3); // at least one terminating zero
+	this->reserve( padded );
+	uint8_t * p = this->buffer.data() + this->used;
+	memcpy( p, string, length );
+	memset( p + length, 0, padded - length );
+	this->used += padded;
+}
+
+
+void OSCBundle::begin( uint64_t timetag )
+{
+	this->used = 0;
+	this->appendPadded( "#bundle" );
+	this->appendUInt32( uint32_t( timetag >> 32 ) );
+	this->appendUInt32( uint32_t( timetag ) );
+}
+
+
+void OSCBundle::beginMessage( const char * address, const char * typeTags )
+{
+	this->messageStart = this->used;
+	this->appendUInt32( 0 ); // size element, patched in endMessage
+	this->appendPadded( address );
+
+	size_t length = strlen( typeTags );
+	size_t padded = ( length + 5 ) & ~size_t(3); // ',' + tags + at least one terminating zero
+	this->reserve( padded );
+	uint8_t * p = this->buffer.data() + this->used;
+	p[0] = ',';
+	memcpy( p + 1, typeTags, length );
+	memset( p + 1 + length, 0, padded - length - 1 );
+	this->used += padded;
+}
+
+
+void OSCBundle::addInt32( int32_t value )
+{
+	this->appendUInt32( uint32_t( value ) );
+}
+
+
+void OSCBundle::addFloat( float value )
+{
+	uint32_t bits;
+	memcpy( &bits, &value, sizeof(bits) );
+	this->appendUInt32( bits );
+}
+
+
+void OSCBundle::addString( const char * value )
+{
+	this->appendPadded( value );
+}
+
+
+void OSCBundle::endMessage()
+{
+	uint32_t size = uint32_t( this->used - this->messageStart - 4 );
+	uint8_t * p = this->buffer.data() + this->messageStart;
+	p[0] = size >> 24;
+	p[1] = size >> 16;
+	p[2] = size >> 8;
+	p[3] = size;
+}
+
+
+uint64_t OSCBundle::now()
+{
+	auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+	auto seconds = std::chrono::duration_cast< std::chrono::seconds >( sinceEpoch );
+	auto nanoseconds = std::chrono::duration_cast< std::chrono::nanoseconds >( sinceEpoch - seconds );
+	uint64_t fraction = ( uint64_t( nanoseconds.count() ) << 32 ) / 1000000000ULL;
+	return ( ( uint64_t( seconds.count() ) + ntpUnixOffset ) << 32 ) | fraction;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTOUTPUT_OSCBUNDLE__INCLUDED_
+#define _POINTOUTPUT_OSCBUNDLE__INCLUDED_
+
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+
+namespace PointOutput
+{
+
+/**
+ * Serializes a single OSC 1.0 bundle into a reusable buffer.
+ *
+ * The buffer keeps its capacity between bundles, so once it has grown to the
+ * size of a typical frame no further allocations happen. Only the argument
+ * types needed for TUIO are supported (int32, float32 and string).
+ */
+class OSCBundle
+{
+public:
+	explicit OSCBundle( size_t reserve = 4096 );
+
+	/// Discards the previous content and starts a new bundle with the given NTP timetag.
+	void begin( uint64_t timetag );
+	/// Starts a message - typeTags lists the argument types without the leading ','.
+	void beginMessage( const char * address, const char * typeTags );
+	void addInt32( int32_t value );
+	void addFloat( float value );
+	void addString( const char * value );
+	/// Finishes the current message by patching its size element.
+	void endMessage();
+
+	const uint8_t * data() const { return this->buffer.data(); }
+	size_t size() const { return this->used; }
+
+	/// Current time as NTP timetag (seconds since 1900 in the upper 32 bits, fraction in the lower).
+	static uint64_t now();
+
+private:
+	void appendUInt32( uint32_t value );
+	void appendPadded( const char * string );
+	void reserve( size_t bytes );
+
+	std::vector< uint8_t > buffer;
+	size_t used = 0;
+	size_t messageStart = 0;
+};
+
+}
+
+
+#endif
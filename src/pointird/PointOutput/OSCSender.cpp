@@ -0,0 +1,385 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OSCSender.hpp"
+#include "../exceptions.hpp"
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <cstring>
+
+#ifdef _WIN32
+	#include <winsock2.h>
+	#include <ws2tcpip.h>
+	typedef SOCKET SocketHandle;
+	static const SocketHandle invalidSocket = INVALID_SOCKET;
+	static int closeSocket( SocketHandle s ) { return closesocket( s ); }
+	static int lastSocketError() { return WSAGetLastError(); }
+	static bool wouldBlock( int error ) { return WSAEWOULDBLOCK == error; }
+	static bool inProgress( int error ) { return WSAEWOULDBLOCK == error || WSAEINPROGRESS == error; }
+	static const int sendFlags = 0;
+#else
+	#include <sys/types.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <sys/select.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
+	#include <netdb.h>
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <errno.h>
+	typedef int SocketHandle;
+	static const SocketHandle invalidSocket = -1;
+	static int closeSocket( SocketHandle s ) { return close( s ); }
+	static int lastSocketError() { return errno; }
+	static bool wouldBlock( int error ) { return EAGAIN == error || EWOULDBLOCK == error; }
+	static bool inProgress( int error ) { return EINPROGRESS == error; }
+	static const int sendFlags = MSG_NOSIGNAL;
+#endif
+
+
+using namespace PointOutput;
+
+
+// time between attempts to (re-)connect a stream destination
+static const std::chrono::seconds reconnectInterval( 1 );
+
+static const std::string udpPrefix = "osc.udp://";
+static const std::string tcpPrefix = "osc.tcp://";
+static const std::string unixPrefix = "osc.unix://";
+
+
+static void setNonBlocking( SocketHandle fd )
+{
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+	if( ioctlsocket( fd, FIONBIO, &nonBlocking ) )
+		throw RUNTIME_ERROR( "Could not make socket non-blocking" );
+#else
+	int flags = fcntl( fd, F_GETFL, 0 );
+	if( -1 == flags )
+		throw SYSTEM_ERROR( errno, "fcntl" );
+	if( -1 == fcntl( fd, F_SETFL, flags | O_NONBLOCK ) )
+		throw SYSTEM_ERROR( errno, "fcntl" );
+#endif
+}
+
+
+class OSCSender::Impl
+{
+public:
+	enum Transport
+	{
+		UDP,
+		TCP,
+		UNIX
+	};
+
+	std::string url;
+	Transport transport = UDP;
+	SocketHandle fd = invalidSocket;
+	struct sockaddr_storage destination;
+	socklen_t destinationLength = 0;
+
+	// stream transports only
+	bool connecting = false;
+	bool connected = false;
+	std::chrono::steady_clock::time_point nextConnect;
+	std::vector< uint8_t > pending; // rest of a packet the socket didn't take at once
+	size_t pendingOffset = 0;
+
+	// only report changes between working and failing to keep the log readable
+	bool failing = false;
+
+	void resolve( const std::string & hostPort, int socketType );
+	void connect();
+	void disconnect();
+	bool checkConnected();
+	bool flush();
+	void sendDatagram( const uint8_t * data, size_t size );
+	void sendStream( const uint8_t * data, size_t size );
+	void reportFailure( const std::string & what, int error );
+	void reportSuccess();
+};
+
+
+void OSCSender::Impl::resolve( const std::string & hostPort, int socketType )
+{
+	std::string address = hostPort;
+	if( !address.empty() && address.back() == '/' )
+		address.pop_back();
+	size_t colon = address.rfind( ':' );
+	if( colon == std::string::npos )
+		throw RUNTIME_ERROR( "Missing port in OSC address \"" + this->url + "\"" );
+	std::string host = address.substr( 0, colon );
+	std::string port = address.substr( colon + 1 );
+	if( host.size() >= 2 && host.front() == '[' && host.back() == ']' )
+		host = host.substr( 1, host.size() - 2 );
+
+	struct addrinfo hints;
+	memset( &hints, 0, sizeof(hints) );
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = socketType;
+	struct addrinfo * result = nullptr;
+	int error = getaddrinfo( host.c_str(), port.c_str(), &hints, &result );
+	if( error )
+		throw RUNTIME_ERROR( "Could not resolve OSC address \"" + this->url + "\": " + gai_strerror( error ) );
+	memcpy( &this->destination, result->ai_addr, result->ai_addrlen );
+	this->destinationLength = result->ai_addrlen;
+	freeaddrinfo( result );
+}
+
+
+void OSCSender::Impl::connect()
+{
+	this->nextConnect = std::chrono::steady_clock::now() + reconnectInterval;
+	this->fd = socket( this->destination.ss_family, SOCK_STREAM, 0 );
+	if( this->fd == invalidSocket )
+	{
+		this->reportFailure( "socket", lastSocketError() );
+		return;
+	}
+	setNonBlocking( this->fd );
+	int noDelay = 1;
+	setsockopt( this->fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast< const char * >( &noDelay ), sizeof(noDelay) );
+	if( ::connect( this->fd, reinterpret_cast< const struct sockaddr * >( &this->destination ), this->destinationLength ) == 0 )
+	{
+		this->connected = true;
+		return;
+	}
+	int error = lastSocketError();
+	if( inProgress( error ) )
+	{
+		this->connecting = true;
+		return;
+	}
+	this->reportFailure( "connect", error );
+	this->disconnect();
+}
+
+
+void OSCSender::Impl::disconnect()
+{
+	if( this->fd != invalidSocket )
+		closeSocket( this->fd );
+	this->fd = invalidSocket;
+	this->connecting = false;
+	this->connected = false;
+	this->pending.clear();
+	this->pendingOffset = 0;
+}
+
+
+// finishes a non-blocking connect - returns true once the stream is usable
+bool OSCSender::Impl::checkConnected()
+{
+	if( this->connected )
+		return true;
+	if( !this->connecting )
+	{
+		if( std::chrono::steady_clock::now() >= this->nextConnect )
+			this->connect();
+		if( !this->connecting )
+			return this->connected;
+	}
+
+	fd_set writable;
+	FD_ZERO( &writable );
+	FD_SET( this->fd, &writable );
+	struct timeval timeout = { 0, 0 };
+	int ready = select( int( this->fd ) + 1, nullptr, &writable, nullptr, &timeout );
+	if( ready == 0 )
+		return false; // still connecting
+	int error = 0;
+	socklen_t errorLength = sizeof(error);
+	if( ready < 0 || getsockopt( this->fd, SOL_SOCKET, SO_ERROR, reinterpret_cast< char * >( &error ), &errorLength ) )
+		error = lastSocketError();
+	if( error )
+	{
+		this->reportFailure( "connect", error );
+		this->disconnect();
+		return false;
+	}
+	this->connecting = false;
+	this->connected = true;
+	return true;
+}
+
+
+// sends what is left of the last packet - returns false if the destination is still busy
+bool OSCSender::Impl::flush()
+{
+	while( this->pendingOffset < this->pending.size() )
+	{
+		auto sent = ::send( this->fd, reinterpret_cast< const char * >( this->pending.data() + this->pendingOffset ),
+		                    this->pending.size() - this->pendingOffset, sendFlags );
+		if( sent < 0 )
+		{
+			int error = lastSocketError();
+			if( wouldBlock( error ) )
+				return false;
+			this->reportFailure( "send", error );
+			this->disconnect();
+			return false;
+		}
+		this->pendingOffset += sent;
+	}
+	this->pending.clear();
+	this->pendingOffset = 0;
+	return true;
+}
+
+
+void OSCSender::Impl::sendDatagram( const uint8_t * data, size_t size )
+{
+	auto sent = sendto( this->fd, reinterpret_cast< const char * >( data ), size, 0,
+	                    reinterpret_cast< const struct sockaddr * >( &this->destination ), this->destinationLength );
+	if( sent < 0 )
+	{
+		// a full send buffer just drops this packet
+		int error = lastSocketError();
+		if( !wouldBlock( error ) )
+			this->reportFailure( "sendto", error );
+		return;
+	}
+	this->reportSuccess();
+}
+
+
+void OSCSender::Impl::sendStream( const uint8_t * data, size_t size )
+{
+	if( !this->checkConnected() )
+		return;
+	if( !this->flush() )
+		return; // busy with the last packet - drop this one
+	uint8_t prefix[4] = { uint8_t( size >> 24 ), uint8_t( size >> 16 ), uint8_t( size >> 8 ), uint8_t( size ) };
+	this->pending.assign( prefix, prefix + 4 );
+	this->pending.insert( this->pending.end(), data, data + size );
+	// a packet only counts as sent once the socket took all of it
+	if( this->flush() )
+		this->reportSuccess();
+}
+
+
+void OSCSender::Impl::reportFailure( const std::string & what, int error )
+{
+	if( this->failing )
+		return;
+	this->failing = true;
+	std::cerr << "PointOutput::OSCSender: " << what << " failed for \"" << this->url << "\": " << strerror( error ) << "\n";
+}
+
+
+void OSCSender::Impl::reportSuccess()
+{
+	if( !this->failing )
+		return;
+	this->failing = false;
+	std::cerr << "PointOutput::OSCSender: Sending to \"" << this->url << "\" works again\n";
+}
+
+
+OSCSender::OSCSender( const std::string & url ) :
+	pImpl( new Impl )
+{
+	this->pImpl->url = url;
+#ifdef _WIN32
+	WSADATA wsaData;
+	if( WSAStartup( MAKEWORD( 2, 2 ), &wsaData ) )
+		throw RUNTIME_ERROR( "Could not initialize Winsock" );
+#endif
+	try
+	{
+		if( url.compare( 0, udpPrefix.size(), udpPrefix ) == 0 )
+		{
+			this->pImpl->transport = Impl::UDP;
+			this->pImpl->resolve( url.substr( udpPrefix.size() ), SOCK_DGRAM );
+			this->pImpl->fd = socket( this->pImpl->destination.ss_family, SOCK_DGRAM, 0 );
+			if( this->pImpl->fd == invalidSocket )
+				throw RUNTIME_ERROR( "Could not create socket for \"" + url + "\"" );
+			setNonBlocking( this->pImpl->fd );
+		}
+		else if( url.compare( 0, tcpPrefix.size(), tcpPrefix ) == 0 )
+		{
+			this->pImpl->transport = Impl::TCP;
+			this->pImpl->resolve( url.substr( tcpPrefix.size() ), SOCK_STREAM );
+			this->pImpl->connect();
+		}
+#ifdef __unix__
+		else if( url.compare( 0, unixPrefix.size(), unixPrefix ) == 0 )
+		{
+			this->pImpl->transport = Impl::UNIX;
+			std::string path = url.substr( unixPrefix.size() );
+			struct sockaddr_un * address = reinterpret_cast< struct sockaddr_un * >( &this->pImpl->destination );
+			if( path.empty() || path.size() >= sizeof(address->sun_path) )
+				throw RUNTIME_ERROR( "Invalid socket path in OSC address \"" + url + "\"" );
+			memset( address, 0, sizeof(struct sockaddr_un) );
+			address->sun_family = AF_UNIX;
+			strncpy( address->sun_path, path.c_str(), sizeof(address->sun_path) - 1 );
+			this->pImpl->destinationLength = sizeof(struct sockaddr_un);
+			this->pImpl->fd = socket( AF_UNIX, SOCK_DGRAM, 0 );
+			if( this->pImpl->fd == invalidSocket )
+				throw SYSTEM_ERROR( errno, "socket" );
+			setNonBlocking( this->pImpl->fd );
+		}
+#endif
+		else
+		{
+			std::string expected = "\"" + udpPrefix + "host:port\", \"" + tcpPrefix + "host:port\"";
+#ifdef __unix__
+			expected += " or \"" + unixPrefix + "/path\"";
+#endif
+			throw RUNTIME_ERROR( "Unsupported OSC address \"" + url + "\" - expected " + expected );
+		}
+	}
+	catch( ... )
+	{
+		this->pImpl->disconnect();
+#ifdef _WIN32
+		WSACleanup();
+#endif
+		throw;
+	}
+}
+
+
+OSCSender::~OSCSender()
+{
+	this->pImpl->disconnect();
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+
+void OSCSender::send( const uint8_t * data, size_t size )
+{
+	if( this->pImpl->transport == Impl::TCP )
+		this->pImpl->sendStream( data, size );
+	else
+		this->pImpl->sendDatagram( data, size );
+}
+
+
+const std::string & OSCSender::getURL() const
+{
+	return this->pImpl->url;
+}
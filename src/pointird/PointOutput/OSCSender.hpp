@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTOUTPUT_OSCSENDER__INCLUDED_
+#define _POINTOUTPUT_OSCSENDER__INCLUDED_
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+
+
+namespace PointOutput
+{
+
+/**
+ * Sends OSC packets to a single destination without ever blocking the caller.
+ *
+ * Supported urls are "osc.udp://host:port", "osc.tcp://host:port" (packets prefixed by their size
+ * as required by OSC 1.0 for stream transports) and "osc.unix:///path/to/socket" (datagrams).
+ * Packets the destination can't take at the moment are dropped. TCP connections are
+ * (re-)established in the background.
+ */
+class OSCSender
+{
+public:
+	OSCSender( const OSCSender & ) = delete; // disable copy constructor
+	OSCSender & operator=( const OSCSender & other ) = delete; // disable assignment operator
+
+	explicit OSCSender( const std::string & url );
+	~OSCSender();
+
+	void send( const uint8_t * data, size_t size );
+
+	const std::string & getURL() const;
+
+private:
+	class Impl;
+	std::unique_ptr< Impl > pImpl;
+};
+
+}
+
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SharedMemory.hpp"
+#include "../exceptions.hpp"
+
+#include <PointIR/PointArray.h>
+#include <PointIR/SharedPointRing.h>
+
+#include <iostream>
+#include <algorithm>
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include <linux/futex.h>
+
+
+using namespace PointOutput;
+
+
+class SharedMemory::Impl
+{
+public:
+	PointIR_SharedPointRing * ring = nullptr;
+	PointIR_SharedPointRing_Waiters * waiters = nullptr;
+	uint32_t head = 0;
+	bool truncationReported = false;
+};
+
+
+/// Creates a fresh zero filled object - readers of a previous one keep their own mapping.
+static void * createObject( const std::string & name, size_t size, mode_t mode )
+{
+	if( -1 == shm_unlink( name.c_str() ) && ENOENT != errno )
+		throw SYSTEM_ERROR( errno, "shm_unlink(\"" + name + "\")" );
+
+	int fd = shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600 );
+	if( -1 == fd )
+		throw SYSTEM_ERROR( errno, "shm_open(\"" + name + "\")" );
+
+	// set the mode regardless of the umask
+	if( -1 == fchmod( fd, mode ) || -1 == ftruncate( fd, size ) )
+	{
+		int error = errno;
+		close( fd );
+		shm_unlink( name.c_str() );
+		throw SYSTEM_ERROR( error, "creating \"" + name + "\"" );
+	}
+
+	void * mapping = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	int error = errno;
+	close( fd );
+	if( MAP_FAILED == mapping )
+	{
+		shm_unlink( name.c_str() );
+		throw SYSTEM_ERROR( error, "mmap(\"" + name + "\")" );
+	}
+	return mapping;
+}
+
+
+SharedMemory::SharedMemory( const std::string & name ) :
+	pImpl( new Impl )
+{
+	this->name = name;
+
+	// Readers need write access to register as waiter - the counter gets its own object, so they can map the ring
+	// read only. Both are only shared with the group of pointird. The counter is created first, so readers finding
+	// the ring also find it.
+	std::string waitersName = this->name + POINTIR_SHAREDPOINTRING_WAITERS_SUFFIX;
+	this->pImpl->waiters = static_cast< PointIR_SharedPointRing_Waiters * >(
+		createObject( waitersName, sizeof(PointIR_SharedPointRing_Waiters), 0660 ) );
+	try
+	{
+		this->pImpl->ring = static_cast< PointIR_SharedPointRing * >( createObject( this->name, sizeof(PointIR_SharedPointRing), 0660 ) );
+	}
+	catch( ... )
+	{
+		munmap( this->pImpl->waiters, sizeof(PointIR_SharedPointRing_Waiters) );
+		shm_unlink( waitersName.c_str() );
+		throw;
+	}
+
+	// head 0 means nothing was published yet
+	this->pImpl->ring->version = POINTIR_SHAREDPOINTRING_VERSION;
+	this->pImpl->ring->slotCount = POINTIR_SHAREDPOINTRING_SLOTS;
+	this->pImpl->ring->maxPoints = POINTIR_SHAREDPOINTRING_MAX_POINTS;
+	__atomic_store_n( &this->pImpl->ring->magic, POINTIR_SHAREDPOINTRING_MAGIC, __ATOMIC_RELEASE );
+
+	std::cout << "PointOutput::SharedMemory: publishing points in \"" << this->name << "\"\n";
+}
+
+
+SharedMemory::~SharedMemory()
+{
+	if( this->pImpl->ring )
+	{
+		// wake sleeping readers - they will time out on their next wait instead of sleeping forever
+		syscall( SYS_futex, &this->pImpl->ring->head, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0 );
+		munmap( this->pImpl->ring, sizeof(PointIR_SharedPointRing) );
+	}
+	munmap( this->pImpl->waiters, sizeof(PointIR_SharedPointRing_Waiters) );
+	for( const std::string & name : { this->name, this->name + POINTIR_SHAREDPOINTRING_WAITERS_SUFFIX } )
+	{
+		if( -1 == shm_unlink( name.c_str() ) )
+			std::cerr << std::string(__PRETTY_FUNCTION__) << ": shm_unlink(\"" << name << "\") failed: " << strerror( errno ) << "\n";
+	}
+}
+
+
+void SharedMemory::outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > &,
+                                 const Tracker::TrackedPoints & )
+{
+	PointIR_SharedPointRing * ring = this->pImpl->ring;
+	PointIR_SharedPointRing_Slot & slot = ring->slots[ this->pImpl->head % POINTIR_SHAREDPOINTRING_SLOTS ];
+
+	uint32_t count = std::min< uint32_t >( pointArray.size(), POINTIR_SHAREDPOINTRING_MAX_POINTS );
+	if( count < pointArray.size() && !this->pImpl->truncationReported )
+	{
+		std::cerr << std::string(__PRETTY_FUNCTION__) << ": more than " << POINTIR_SHAREDPOINTRING_MAX_POINTS << " points - truncating\n";
+		this->pImpl->truncationReported = true;
+	}
+
+	// seqlock write: odd sequence while the slot is inconsistent
+	uint32_t sequence = __atomic_load_n( &slot.sequence, __ATOMIC_RELAXED );
+	__atomic_store_n( &slot.sequence, sequence + 1, __ATOMIC_RELAXED );
+	__atomic_thread_fence( __ATOMIC_RELEASE );
+	__atomic_store_n( &slot.count, count, __ATOMIC_RELAXED );
+	memcpy( static_cast< void * >( slot.points ), pointArray.data(), count * sizeof(PointIR_Point) );
+	__atomic_store_n( &slot.sequence, sequence + 2, __ATOMIC_RELEASE );
+
+	this->pImpl->head++;
+	__atomic_store_n( &ring->head, this->pImpl->head, __ATOMIC_SEQ_CST );
+
+	// only enter the kernel if someone is actually sleeping
+	if( __atomic_load_n( &this->pImpl->waiters->waiters, __ATOMIC_SEQ_CST ) )
+		syscall( SYS_futex, &ring->head, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0 );
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _POINTOUTPUT_SHAREDMEMORY__INCLUDED_
+#define _POINTOUTPUT_SHAREDMEMORY__INCLUDED_
+
+
+#include "APointOutput.hpp"
+
+#include <string>
+#include <memory>
+
+
+namespace PointOutput
+{
+
+/// Publishes points into a POSIX shared memory ring - see PointIR/SharedPointRing.h for the layout and a reader.
+class SharedMemory : public APointOutput
+{
+public:
+	SharedMemory( const SharedMemory & ) = delete; // disable copy constructor
+	SharedMemory & operator=( const SharedMemory & other ) = delete; // disable assignment operator
+
+	SharedMemory() : SharedMemory( "/PointIR.points" ) {}
+	SharedMemory( const std::string & name );
+	virtual ~SharedMemory();
+
+	virtual void outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+	                           const Tracker::TrackedPoints & trackedPoints ) override;
+
+	const std::string & getName() const { return this->name; }
+
+private:
+	std::string name;
+
+	class Impl;
+	std::unique_ptr< Impl > pImpl;
+};
+
+}
+
+#endif
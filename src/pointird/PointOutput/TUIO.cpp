@@ -17,21 +17,17 @@
  * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-
 #include "TUIO.hpp"
+#include "OSCBundle.hpp"
+#include "OSCSender.hpp"
 #include "../exceptions.hpp"
-#include "../TrackerFactory.hpp"
+#include "../Tracker/TrackedPoints.hpp"
 
 #include <PointIR/PointArray.h>
 
 #include <iostream>
 #include <vector>
-
-//HACK: liblo headers seem broken: they use WIN32 instead of _WIN32 !?
-#ifdef _WIN32
-	#define WIN32
-#endif
-#include <lo/lo.h>
+#include <cmath>
 
 
 using namespace PointOutput;
@@ -40,103 +36,193 @@ using namespace PointOutput;
 class TUIO::Impl
 {
 public:
-	lo_address tuioAddr = nullptr;
+	std::vector< std::unique_ptr< OSCSender > > senders;
+
+	OSCBundle bundle;
+	std::string aliveTypeTags;
 	uint32_t frameID = 0;
-	lo_timetag lastTimetag;
-
-	Tracker::ATracker * tracker = nullptr;
-	PointIR::PointArray previousPoints;
-	std::vector< int > previousIDs;
-	std::vector< int > currentIDs;
-	std::vector< int > currentToPrevious;
-	std::vector< int > previousToCurrent;
+	bool blobProfile = false;
+	bool warnedUntracked = false;
+
+	std::vector< PointIR::Blob > previousBlobs;
+
+	// accelerations of the current points - the speeds are kept for the next frame
+	std::vector< float > previousSpeeds;
+	std::vector< float > currentSpeeds;
+	std::vector< float > motionAccelerations;
+	std::vector< float > previousRotationSpeeds;
+	std::vector< float > currentRotationSpeeds;
+	std::vector< float > rotationAccelerations;
+
+	void updateMotion( const Tracker::TrackedPoints & trackedPoints, const std::vector< PointIR::Blob > & blobs );
+	void beginBundle( const char * profile, const Tracker::TrackedPoints & trackedPoints );
+	void endBundle( const char * profile );
+	void send();
 };
 
 
-TUIO::TUIO( const TrackerFactory & trackerFactory, std::string address ) :
+TUIO::TUIO( const std::vector< std::string > & addresses, bool blobProfile ) :
 	pImpl( new Impl )
 {
-	this->pImpl->tuioAddr = lo_address_new_from_url( address.c_str() );
-	if( !this->pImpl->tuioAddr )
-		throw RUNTIME_ERROR("Could not start OSC/TUIO server");
+	if( addresses.empty() )
+		throw RUNTIME_ERROR( "No TUIO destination given" );
+	this->pImpl->blobProfile = blobProfile;
+	for( const std::string & address : addresses )
+		this->pImpl->senders.emplace_back( new OSCSender( address ) );
+
+	for( const std::string & address : addresses )
+		std::cout << "PointOutput::TUIO: Sending to \"" << address << "\"" << ( blobProfile ? " with blob profile" : "" ) << "\n";
+}
 
-	this->pImpl->tracker = trackerFactory.newTracker();
 
-	char * addr = lo_address_get_url(this->pImpl->tuioAddr);
-	std::cout << "PointOutput::TUIO: Started server on \"" << addr << "\"\n";
-	free( addr );
+TUIO::~TUIO()
+{
 }
 
 
-TUIO::~TUIO()
+void TUIO::Impl::updateMotion( const Tracker::TrackedPoints & trackedPoints, const std::vector< PointIR::Blob > & blobs )
 {
-	delete this->pImpl->tracker;
+	const float pi = 3.14159265358979f;
+	float dt = trackedPoints.dt;
+	size_t count = trackedPoints.currentIDs.size();
+	this->currentSpeeds.assign( count, 0.0f );
+	this->motionAccelerations.assign( count, 0.0f );
+	this->currentRotationSpeeds.assign( count, 0.0f );
+	this->rotationAccelerations.assign( count, 0.0f );
+	if( dt <= 0.0f )
+		return;
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		const PointIR::Point & velocity = trackedPoints.currentVelocities[i];
+		this->currentSpeeds[i] = std::sqrt( velocity.x * velocity.x + velocity.y * velocity.y );
 
-	lo_address_free( this->pImpl->tuioAddr );
+		int previous = trackedPoints.currentToPrevious[i];
+		if( trackedPoints.currentStates[i] != Tracker::TrackedPoints::MOVE || previous < 0 )
+			continue;
+		this->motionAccelerations[i] = ( this->currentSpeeds[i] - this->previousSpeeds[previous] ) / dt;
+
+		if( !this->blobProfile )
+			continue;
+		// blob angles are only defined up to half a turn - take the shorter way
+		float rotation = blobs[i].angle - this->previousBlobs[previous].angle;
+		if( rotation > pi / 2.0f )
+			rotation -= pi;
+		else if( rotation < -pi / 2.0f )
+			rotation += pi;
+		this->currentRotationSpeeds[i] = rotation / ( 2.0f * pi ) / dt;
+		this->rotationAccelerations[i] = ( this->currentRotationSpeeds[i] - this->previousRotationSpeeds[previous] ) / dt;
+	}
 }
 
 
-void TUIO::outputPoints( const PointIR::PointArray & currentPoints )
+void TUIO::Impl::beginBundle( const char * profile, const Tracker::TrackedPoints & trackedPoints )
 {
-	this->pImpl->tracker->assignIDs( this->pImpl->previousPoints, this->pImpl->previousIDs,
-	                                 currentPoints, this->pImpl->currentIDs,
-	                                 this->pImpl->previousToCurrent, this->pImpl->currentToPrevious );
+	this->bundle.begin( OSCBundle::now() );
 
-	lo_message msg;
+	this->bundle.beginMessage( profile, "ss" );
+	this->bundle.addString( "source" );
+	this->bundle.addString( "PointIR" );
+	this->bundle.endMessage();
 
-	lo_timetag timetag;
-	lo_timetag_now( &timetag );
-	lo_bundle bundle = lo_bundle_new( timetag );
+	this->bundle.beginMessage( profile, this->aliveTypeTags.c_str() );
+	this->bundle.addString( "alive" );
+	for( int id : trackedPoints.currentIDs )
+	{
+		if( id < 0 )
+			continue;
+		this->bundle.addInt32( id );
+	}
+	this->bundle.endMessage();
+}
 
-	msg = lo_message_new();
-	lo_message_add_string( msg, "source" );
-	lo_message_add_string( msg, "PointIR" );
-	lo_bundle_add_message( bundle, "/tuio/2Dcur", msg );
 
-	msg = lo_message_new();
-	lo_message_add_string( msg, "alive" );
-	for( unsigned int i = 0; i < this->pImpl->currentIDs.size(); i++ )
+void TUIO::Impl::endBundle( const char * profile )
+{
+	this->bundle.beginMessage( profile, "si" );
+	this->bundle.addString( "fseq" );
+	this->bundle.addInt32( this->frameID );
+	this->bundle.endMessage();
+	this->send();
+}
+
+
+// the bundle is encoded once and handed to every destination - none of them blocks
+void TUIO::Impl::send()
+{
+	for( auto & sender : this->senders )
+		sender->send( this->bundle.data(), this->bundle.size() );
+}
+
+
+void TUIO::outputPoints( const PointIR::PointArray & currentPoints, const std::vector< PointIR::Blob > & blobs,
+                         const Tracker::TrackedPoints & trackedPoints )
+{
+	if( !trackedPoints.isValid( currentPoints ) )
 	{
-		if( this->pImpl->currentIDs[i] < 0 )
-			continue;
-		lo_message_add_int32( msg, this->pImpl->currentIDs[i] );
+		if( !this->pImpl->warnedUntracked )
+			std::cerr << "PointOutput::TUIO: Need a tracker - ignoring points\n";
+		this->pImpl->warnedUntracked = true;
+		return;
 	}
-	lo_bundle_add_message( bundle, "/tuio/2Dcur", msg ) ;
 
-	double dt = lo_timetag_diff( timetag, this->pImpl->lastTimetag );
-	this->pImpl->lastTimetag = timetag;
+	this->pImpl->updateMotion( trackedPoints, blobs );
+
+	// the type tags depend on the number of alive IDs - reuse the string's capacity
+	this->pImpl->aliveTypeTags.assign( 1, 's' );
+	for( int id : trackedPoints.currentIDs )
+		if( id >= 0 )
+			this->pImpl->aliveTypeTags.push_back( 'i' );
 
+	OSCBundle & bundle = this->pImpl->bundle;
+
+	// /tuio/2Dcur set s x y X Y m
+	this->pImpl->beginBundle( "/tuio/2Dcur", trackedPoints );
 	for( unsigned int i = 0; i < currentPoints.size(); i++ )
 	{
-		if( this->pImpl->currentIDs[i] < 0 )
+		if( trackedPoints.currentIDs[i] < 0 )
 			continue;
-
-		PointIR::Point diff( 0.0f, 0.0f );
-		if( this->pImpl->currentToPrevious[i] >= 0 )
-			diff = ( this->pImpl->previousPoints[this->pImpl->currentToPrevious[i]] - currentPoints[i] ) / dt;
-
-		msg = lo_message_new();
-		lo_message_add_string( msg, "set" );
-		lo_message_add_int32( msg, this->pImpl->currentIDs[i] );
-		lo_message_add_float( msg, currentPoints[i].x );
-		lo_message_add_float( msg, currentPoints[i].y );
-		lo_message_add_float( msg, diff.x );
-		lo_message_add_float( msg, diff.y );
-		lo_message_add_float( msg, 0.0 );
-		lo_bundle_add_message( bundle, "/tuio/2Dcur", msg );
+		bundle.beginMessage( "/tuio/2Dcur", "sifffff" );
+		bundle.addString( "set" );
+		bundle.addInt32( trackedPoints.currentIDs[i] );
+		bundle.addFloat( currentPoints[i].x );
+		bundle.addFloat( currentPoints[i].y );
+		bundle.addFloat( trackedPoints.currentVelocities[i].x );
+		bundle.addFloat( trackedPoints.currentVelocities[i].y );
+		bundle.addFloat( this->pImpl->motionAccelerations[i] );
+		bundle.endMessage();
 	}
+	this->pImpl->endBundle( "/tuio/2Dcur" );
 
-	msg = lo_message_new();
-	lo_message_add_string( msg, "fseq" );
-	lo_message_add_int32( msg, this->pImpl->frameID++ );
-	lo_bundle_add_message( bundle, "/tuio/2Dcur", msg );
-
-	if( lo_send_bundle( this->pImpl->tuioAddr, bundle ) == -1 )
-		std::cerr << "PointOutput::TUIO: OSC error " << lo_address_errno(this->pImpl->tuioAddr) <<": " << lo_address_errstr(this->pImpl->tuioAddr) << "\n";
-
-	// TODO: obsolete but lo_bundle_free_recursive is not yet available everywhere (e.g. raspbian)
-	lo_bundle_free_messages( bundle );
+	// /tuio/2Dblb set s x y a w h f X Y A m r
+	if( this->pImpl->blobProfile )
+	{
+		this->pImpl->beginBundle( "/tuio/2Dblb", trackedPoints );
+		for( unsigned int i = 0; i < currentPoints.size(); i++ )
+		{
+			if( trackedPoints.currentIDs[i] < 0 )
+				continue;
+			bundle.beginMessage( "/tuio/2Dblb", "sifffffffffff" );
+			bundle.addString( "set" );
+			bundle.addInt32( trackedPoints.currentIDs[i] );
+			bundle.addFloat( currentPoints[i].x );
+			bundle.addFloat( currentPoints[i].y );
+			bundle.addFloat( blobs[i].angle );
+			bundle.addFloat( blobs[i].width );
+			bundle.addFloat( blobs[i].height );
+			bundle.addFloat( blobs[i].area );
+			bundle.addFloat( trackedPoints.currentVelocities[i].x );
+			bundle.addFloat( trackedPoints.currentVelocities[i].y );
+			bundle.addFloat( this->pImpl->currentRotationSpeeds[i] );
+			bundle.addFloat( this->pImpl->motionAccelerations[i] );
+			bundle.addFloat( this->pImpl->rotationAccelerations[i] );
+			bundle.endMessage();
+		}
+		this->pImpl->endBundle( "/tuio/2Dblb" );
+		this->pImpl->previousBlobs = blobs;
+	}
 
-	this->pImpl->previousPoints = currentPoints;
-	this->pImpl->previousIDs = this->pImpl->currentIDs;
+	this->pImpl->frameID++;
+	this->pImpl->previousSpeeds.swap( this->pImpl->currentSpeeds );
+	this->pImpl->previousRotationSpeeds.swap( this->pImpl->currentRotationSpeeds );
 }
@@ -25,9 +25,7 @@
 
 #include <memory>
 #include <string>
-
-
-class TrackerFactory;
+#include <vector>
 
 
 namespace PointOutput
@@ -39,10 +37,16 @@ public:
 	TUIO( const TUIO & ) = delete; // disable copy constructor
 	TUIO & operator=( const TUIO & other ) = delete; // disable assignment operator
 
-	TUIO( const TrackerFactory & trackerFactory, std::string address = "osc.udp://127.0.0.1:3333" );
+	/**
+	 * Sends each bundle to all of the given addresses - see OSCSender for the supported transports.
+	 * The session IDs are taken from the processor's tracking stage.
+	 * With blobProfile set, each frame additionally sends a /tuio/2Dblb bundle carrying the size, angle and area of each contact.
+	 */
+	TUIO( const std::vector< std::string > & addresses, bool blobProfile = false );
 	virtual ~TUIO();
 
-	virtual void outputPoints( const PointIR::PointArray & pointArray ) override;
+	virtual void outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+	                           const Tracker::TrackedPoints & trackedPoints ) override;
 
 private:
 	class Impl;
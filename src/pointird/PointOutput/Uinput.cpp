@@ -22,16 +22,22 @@
 
 #include "Uinput.hpp"
 #include "../exceptions.hpp"
+#include "../Tracker/TrackedPoints.hpp"
 
 #include <PointIR/PointArray.h>
+#include <PointIR/Blob.h>
 
 #include <iostream>
 #include <vector>
+#include <chrono>
+#include <algorithm>
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <math.h>
 
 #include <sys/stat.h>
 #include <sys/ioctl.h>
@@ -43,31 +49,66 @@
 using namespace PointOutput;
 
 
-static const int resX = 4096;
-static const int resY = 4096;
-static const int fuzzX = 0;
-static const int fuzzY = 0;
-static const int flatX = 0;
-static const int flatY = 0;
 static const std::string uinputDeviceName("/dev/uinput");
 
+// highest slot number of type B devices
+static const int maxSlot = 0x1ff;
+
+// maximum reported pressure - reached by blobs covering this fraction of the screen
+static const int pressureMax = 255;
+static const float pressureMaxArea = 0.01f;
+
 
 class Uinput::Impl
 {
 public:
+	typedef std::chrono::steady_clock Clock;
+
+	// the state of a contact as last reported to the kernel
+	struct Slot
+	{
+		int trackingID = -1;
+		int x = 0;
+		int y = 0;
+		int touchMajor = 0;
+		int pressure = 0;
+		Clock::time_point lastReport;
+	};
+
+	// a contact converted to device units
+	struct Contact
+	{
+		int x = 0;
+		int y = 0;
+		int touchMajor = 0;
+		int pressure = 0;
+	};
+
 	int fd = 0;
 
+	Settings settings;
+
 	bool hadPreviousContact = true;
 
-	Tracker::ATracker * tracker = nullptr;
-	PointIR::PointArray previousPoints;
-	std::vector< int > previousIDs;
-	std::vector< int > currentIDs;
-	std::vector< int > currentToPrevious;
-	std::vector< int > previousToCurrent;
+	Clock::duration stationaryInterval = std::chrono::milliseconds( 100 );
+	std::vector< Slot > slots;
+	int currentSlot = -1;
 
-	void outputPointsTypeA( const PointIR::PointArray & pointArray );
-	void outputPointsTypeB( const PointIR::PointArray & pointArray );
+	bool typeB = false;
+	bool warnedUntracked = false;
+
+	std::vector< std::pair< __u16, struct input_absinfo > > axes;
+
+	void addAxis( __u16 code, __s32 minimum, __s32 maximum, __s32 fuzz = 0, __s32 resolution = 0 );
+	bool createDevice( const struct input_id & id, const char * name );
+	void createLegacyDevice( const struct input_id & id, const char * name );
+
+	Contact toContact( const PointIR::Point & point, const PointIR::Blob & blob ) const;
+
+	void outputPointsTypeA( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs );
+	void outputPointsTypeB( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+	                        const Tracker::TrackedPoints & trackedPoints );
+	void selectSlot( std::vector< struct input_event > & events, int slot );
 };
 
 
@@ -81,6 +122,16 @@ static int xioctl( int fd, unsigned long int request, decltype(EV_ABS) arg )
 }
 
 
+static int xioctl( int fd, unsigned long int request, void * arg )
+{
+	int r;
+	do
+		r = ioctl( fd, request, arg );
+	while( -1 == r && EINTR == errno );
+	return r;
+}
+
+
 static int xioctl( int fd, unsigned long int request )
 {
 	int r;
@@ -91,50 +142,97 @@ static int xioctl( int fd, unsigned long int request )
 }
 
 
-Uinput::Uinput( const TrackerFactory * trackerFactory ) :
+void Uinput::Impl::addAxis( __u16 code, __s32 minimum, __s32 maximum, __s32 fuzz, __s32 resolution )
+{
+	if( xioctl( this->fd, UI_SET_ABSBIT, code ) == -1 )
+		throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_SET_ABSBIT,"+std::to_string(code)+")" );
+
+	struct input_absinfo absinfo = {};
+	absinfo.minimum = minimum;
+	absinfo.maximum = maximum;
+	absinfo.fuzz = fuzz;
+	absinfo.resolution = resolution;
+	this->axes.push_back( { code, absinfo } );
+}
+
+
+// uses UI_DEV_SETUP and UI_ABS_SETUP (uinput version 5 and later) - returns false if unavailable
+bool Uinput::Impl::createDevice( const struct input_id & id, const char * name )
+{
+#ifdef UI_DEV_SETUP
+	unsigned int version = 0;
+	if( xioctl( this->fd, UI_GET_VERSION, &version ) == -1 || version < 5 )
+		return false;
+
+	for( auto & axis : this->axes )
+	{
+		struct uinput_abs_setup absSetup = {};
+		absSetup.code = axis.first;
+		absSetup.absinfo = axis.second;
+		if( xioctl( this->fd, UI_ABS_SETUP, &absSetup ) == -1 )
+			throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_ABS_SETUP,"+std::to_string(axis.first)+")" );
+	}
+
+	struct uinput_setup setup = {};
+	setup.id = id;
+	snprintf( setup.name, UINPUT_MAX_NAME_SIZE, "%s", name );
+	if( xioctl( this->fd, UI_DEV_SETUP, &setup ) == -1 )
+		throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_DEV_SETUP)" );
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+// the device description written to older uinput versions has no field for the resolution of the axes
+void Uinput::Impl::createLegacyDevice( const struct input_id & id, const char * name )
+{
+	struct uinput_user_dev uidev = {};
+	snprintf( uidev.name, UINPUT_MAX_NAME_SIZE, "%s", name );
+	uidev.id = id;
+
+	for( auto & axis : this->axes )
+	{
+		uidev.absmin[axis.first] = axis.second.minimum;
+		uidev.absmax[axis.first] = axis.second.maximum;
+		uidev.absfuzz[axis.first] = axis.second.fuzz;
+	}
+
+	if( write( this->fd, &uidev, sizeof(uidev) ) != sizeof(uidev) )
+		throw SYSTEM_ERROR( errno, "write(\""+uinputDeviceName+"\",uidev,"+std::to_string(sizeof(uidev))+")" );
+}
+
+
+Uinput::Uinput( bool typeB ) :
+	Uinput( typeB, Settings() )
+{
+}
+
+
+Uinput::Uinput( bool typeB, const Settings & settings ) :
 	pImpl( new Impl )
 {
+	if( settings.width < 2 || settings.height < 2 )
+		throw RUNTIME_ERROR( "uinput axes need at least two positions - got " + std::to_string(settings.width) + "x" + std::to_string(settings.height) );
+
+	if( settings.stationaryInterval < 0.0f )
+		throw RUNTIME_ERROR( "uinput stationary interval must not be negative - got " + std::to_string(settings.stationaryInterval) );
+
+	this->pImpl->settings = settings;
+	this->setStationaryInterval( settings.stationaryInterval );
+
 	this->pImpl->fd = open( uinputDeviceName.c_str(), O_WRONLY | O_NONBLOCK );
 	if( this->pImpl->fd < 0 )
 		throw SYSTEM_ERROR( errno, "open(\""+uinputDeviceName+"\",O_WRONLY|O_NONBLOCK)" );
 
 	// setup device information
-	struct uinput_user_dev uidev = {};
-	snprintf( uidev.name, UINPUT_MAX_NAME_SIZE, "PointIR uinput output" );
-
-	uidev.id.bustype = BUS_VIRTUAL;
-	uidev.id.vendor  = 0x1; //TODO: choose something different?
-	uidev.id.product = 0x1; //TODO: choose something different?
-	uidev.id.version = 1;
-
-	if( trackerFactory )
-		this->pImpl->tracker = trackerFactory->newTracker( 0x1ff );
-	//TODO: the tracker's maximum ID is also used as the maximum ABS_MT_SLOT value below
-	//      interesting fact: a value too high might cause the kernel to freeze! Oo
-	if( this->pImpl->tracker )
-	{
-		uidev.absmax[ABS_MT_SLOT] = this->pImpl->tracker->getMaxID();
-		uidev.absmax[ABS_MT_TRACKING_ID] = this->pImpl->tracker->getMaxID();
-	}
-
-	uidev.absmax[ABS_MT_POSITION_X] = resX;
-	uidev.absmax[ABS_MT_POSITION_Y] = resY;
-	uidev.absmin[ABS_MT_POSITION_X] = 0;
-	uidev.absmin[ABS_MT_POSITION_Y] = 0;
-	uidev.absfuzz[ABS_MT_POSITION_X] = fuzzX;
-	uidev.absflat[ABS_MT_POSITION_X] = flatX;
-	uidev.absfuzz[ABS_MT_POSITION_Y] = fuzzY;
-	uidev.absflat[ABS_MT_POSITION_Y] = flatY;
-
-	//HACK: xorg/udev needs this even for multitouch
-	uidev.absmax[ABS_X] = resX;
-	uidev.absmax[ABS_Y] = resY;
-	uidev.absmin[ABS_X] = 0;
-	uidev.absmin[ABS_Y] = 0;
-	uidev.absfuzz[ABS_X] = fuzzX;
-	uidev.absflat[ABS_X] = flatX;
-	uidev.absfuzz[ABS_Y] = fuzzY;
-	uidev.absflat[ABS_Y] = flatY;
+	struct input_id id = {};
+	id.bustype = BUS_VIRTUAL;
+	id.vendor  = 0x1; //TODO: choose something different?
+	id.product = 0x1; //TODO: choose something different?
+	id.version = 1;
 
 	if( xioctl( this->pImpl->fd, UI_SET_EVBIT, EV_SYN ) == -1 )
 		throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_SET_EVBIT,EV_SYN)" );
@@ -152,41 +250,43 @@ Uinput::Uinput( const TrackerFactory * trackerFactory ) :
 	// using absolute multitouch positions
 	if( xioctl( this->pImpl->fd, UI_SET_EVBIT, EV_ABS ) == -1 )
 		throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_SET_EVBIT,EV_ABS)" );
-	if( xioctl( this->pImpl->fd, UI_SET_ABSBIT, ABS_MT_POSITION_X ) == -1 )
-		throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_SET_ABSBIT,ABS_MT_POSITION_X)" );
-	if( xioctl( this->pImpl->fd, UI_SET_ABSBIT, ABS_MT_POSITION_Y ) == -1 )
-		throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_SET_ABSBIT,ABS_MT_POSITION_Y)" );
 
-	// if using B protocol
-	if( this->pImpl->tracker )
+	int maxX = settings.width - 1;
+	int maxY = settings.height - 1;
+	this->pImpl->addAxis( ABS_MT_POSITION_X, 0, maxX, settings.fuzz, settings.resolution );
+	this->pImpl->addAxis( ABS_MT_POSITION_Y, 0, maxY, settings.fuzz, settings.resolution );
+	this->pImpl->addAxis( ABS_MT_TOUCH_MAJOR, 0, std::max( maxX, maxY ), settings.fuzz, settings.resolution );
+	this->pImpl->addAxis( ABS_MT_PRESSURE, 0, pressureMax );
+
+	// if using B protocol - the tracking IDs are used as slot numbers
+	//      interesting fact: a maximum slot value too high might cause the kernel to freeze! Oo
+	this->pImpl->typeB = typeB;
+	if( typeB )
 	{
-		if( xioctl( this->pImpl->fd, UI_SET_ABSBIT, ABS_MT_SLOT ) == -1 )
-			throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_SET_ABSBIT,ABS_MT_SLOT)" );
-		if( xioctl( this->pImpl->fd, UI_SET_ABSBIT, ABS_MT_TRACKING_ID ) == -1 )
-			throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_SET_ABSBIT,ABS_MT_TRACKING_ID)" );
+		this->pImpl->addAxis( ABS_MT_SLOT, 0, maxSlot );
+		this->pImpl->addAxis( ABS_MT_TRACKING_ID, 0, maxSlot );
+		this->pImpl->slots.resize( maxSlot + 1 );
 	}
 
 	//HACK: xorg/udev needs this to recognize it as touchscreen?
-	if( xioctl( this->pImpl->fd, UI_SET_ABSBIT, ABS_X ) == -1 )
-		throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_SET_ABSBIT,ABS_X)" );
-	if( xioctl( this->pImpl->fd, UI_SET_ABSBIT, ABS_Y ) == -1 )
-		throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_SET_ABSBIT,ABS_Y)" );
+	this->pImpl->addAxis( ABS_X, 0, maxX, settings.fuzz, settings.resolution );
+	this->pImpl->addAxis( ABS_Y, 0, maxY, settings.fuzz, settings.resolution );
 
-	if( write( this->pImpl->fd, &uidev, sizeof(uidev) ) != sizeof(uidev) )
-		throw SYSTEM_ERROR( errno, "write(\""+uinputDeviceName+"\",uidev,"+std::to_string(sizeof(uidev))+")" );
+	const char * name = "PointIR uinput output";
+	bool legacy = !this->pImpl->createDevice( id, name );
+	if( legacy )
+		this->pImpl->createLegacyDevice( id, name );
 
 	if( xioctl( this->pImpl->fd, UI_DEV_CREATE ) == -1 )
 		throw SYSTEM_ERROR( errno, "ioctl(\""+uinputDeviceName+"\",UI_DEV_CREATE)" );
 
-	std::cout << "PointOutput::Uinput: Generating type " << ((this->pImpl->tracker) ? "B":"A") << " input events\n";
+	std::cout << "PointOutput::Uinput: Generating type " << (typeB ? "B":"A") << " input events on "
+		<< settings.width << "x" << settings.height << " axes" << (legacy ? " (legacy setup)" : "") << "\n";
 }
 
 
 Uinput::~Uinput()
 {
-	if( this->pImpl->tracker )
-		delete this->pImpl->tracker;
-
 	if( this->pImpl->fd )
 	{
 		if( xioctl( this->pImpl->fd, UI_DEV_DESTROY ) == -1 )
@@ -214,11 +314,13 @@ static std::map< int, std::string > eventCodeStrings =
 	{ABS_MT_TRACKING_ID,"ABS_MT_TRACKING_ID"},
 	{ABS_MT_POSITION_X,"ABS_MT_POSITION_X"},
 	{ABS_MT_POSITION_Y,"ABS_MT_POSITION_Y"},
+	{ABS_MT_TOUCH_MAJOR,"ABS_MT_TOUCH_MAJOR"},
+	{ABS_MT_PRESSURE,"ABS_MT_PRESSURE"},
 	{SYN_REPORT,"SYN_REPORT"},
 };
 #endif
 
-static void addEvent( std::vector< struct input_event > & events, __u16 type, __u16 code, __s16 value = 0 )
+static void addEvent( std::vector< struct input_event > & events, __u16 type, __u16 code, __s32 value = 0 )
 {
 #ifdef _POINTOUTPUT_UINPUT__LIVEDEBUG_
 	std::cerr << "PointOutput::Uinput:\ttype= " << eventTypeStrings[type] << "\tcode= " << eventCodeStrings[code] << "\tvalue= " << value << "\n";
@@ -231,17 +333,67 @@ static void addEvent( std::vector< struct input_event > & events, __u16 type, __
 }
 
 
+static int clamp( int value, int minimum, int maximum )
+{
+	if( value < minimum )
+		return minimum;
+	if( value > maximum )
+		return maximum;
+	return value;
+}
+
+
+Uinput::Impl::Contact Uinput::Impl::toContact( const PointIR::Point & point, const PointIR::Blob & blob ) const
+{
+	int maxX = this->settings.width - 1;
+	int maxY = this->settings.height - 1;
+
+	Contact contact;
+	contact.x = clamp( lround( point.x * maxX ), 0, maxX );
+	contact.y = clamp( lround( point.y * maxY ), 0, maxY );
+	contact.touchMajor = clamp( lround( std::max( blob.width * maxX, blob.height * maxY ) ), 0, std::max( maxX, maxY ) );
+	// at least 1 - some userspace drivers treat zero pressure as released contact
+	contact.pressure = clamp( lround( blob.area / pressureMaxArea * pressureMax ), 1, pressureMax );
+	return contact;
+}
+
+
+void Uinput::setDeadband( int deadband )
+{
+	this->pImpl->settings.deadband = deadband;
+}
+
+
+int Uinput::getDeadband() const
+{
+	return this->pImpl->settings.deadband;
+}
+
+
+void Uinput::setStationaryInterval( float seconds )
+{
+	this->pImpl->stationaryInterval = std::chrono::duration_cast< Impl::Clock::duration >( std::chrono::duration< float >( seconds ) );
+}
+
+
+float Uinput::getStationaryInterval() const
+{
+	return std::chrono::duration_cast< std::chrono::duration< float > >( this->pImpl->stationaryInterval ).count();
+}
+
+
 // https://www.kernel.org/doc/Documentation/input/multi-touch-protocol.txt
-void Uinput::outputPoints( const PointIR::PointArray & pointArray )
+void Uinput::outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+                           const Tracker::TrackedPoints & trackedPoints )
 {
-	if( this->pImpl->tracker )
-		this->pImpl->outputPointsTypeB( pointArray );
+	if( this->pImpl->typeB )
+		this->pImpl->outputPointsTypeB( pointArray, blobs, trackedPoints );
 	else
-		this->pImpl->outputPointsTypeA( pointArray );
+		this->pImpl->outputPointsTypeA( pointArray, blobs );
 }
 
 
-void Uinput::Impl::outputPointsTypeA( const PointIR::PointArray & pointArray )
+void Uinput::Impl::outputPointsTypeA( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs )
 {
 	std::vector< struct input_event > events;
 
@@ -261,23 +413,14 @@ void Uinput::Impl::outputPointsTypeA( const PointIR::PointArray & pointArray )
 //		{
 //			addEvent( events, EV_KEY, BTN_TOUCH, 1 );
 //		}
-		for( const PointIR_Point & point : pointArray )
+		for( unsigned int i = 0; i < pointArray.size(); i++ )
 		{
-			int16_t x = resX * point.x;
-			int16_t y = resY * point.y;
-
-			if( x >= resX )
-				x = resX - 1;
-			else if( x < 0 )
-				x = 0;
-
-			if( y >= resY )
-				y = resY - 1;
-			else if( y < 0 )
-				y = 0;
+			Contact contact = this->toContact( pointArray[i], blobs[i] );
 
-			addEvent( events, EV_ABS, ABS_MT_POSITION_X, x );
-			addEvent( events, EV_ABS, ABS_MT_POSITION_Y, y );
+			addEvent( events, EV_ABS, ABS_MT_POSITION_X, contact.x );
+			addEvent( events, EV_ABS, ABS_MT_POSITION_Y, contact.y );
+			addEvent( events, EV_ABS, ABS_MT_TOUCH_MAJOR, contact.touchMajor );
+			addEvent( events, EV_ABS, ABS_MT_PRESSURE, contact.pressure );
 			addEvent( events, EV_SYN, SYN_MT_REPORT );
 
 			this->hadPreviousContact = true;
@@ -327,51 +470,101 @@ void Uinput::Impl::outputPointsTypeA( const PointIR::PointArray & pointArray )
 }
 
 
-void Uinput::Impl::outputPointsTypeB( const PointIR::PointArray & currentPoints )
+void Uinput::Impl::selectSlot( std::vector< struct input_event > & events, int slot )
 {
-	std::vector< struct input_event > events;
+	// the kernel remembers the selected slot across reports
+	if( this->currentSlot == slot )
+		return;
+	addEvent( events, EV_ABS, ABS_MT_SLOT, slot );
+	this->currentSlot = slot;
+}
 
-	this->tracker->assignIDs( this->previousPoints, this->previousIDs,
-	                          currentPoints, this->currentIDs,
-	                          this->previousToCurrent, this->currentToPrevious );
 
-	// update / add new contacts
-	for( unsigned int i = 0; i < currentPoints.size(); i++ )
+void Uinput::Impl::outputPointsTypeB( const PointIR::PointArray & currentPoints, const std::vector< PointIR::Blob > & blobs,
+                                      const Tracker::TrackedPoints & trackedPoints )
+{
+	if( !trackedPoints.isValid( currentPoints ) )
 	{
-		if( this->currentIDs[i] < 0 )
-			continue;
-
-		addEvent( events, EV_ABS, ABS_MT_SLOT, this->currentIDs[i] );
-		addEvent( events, EV_ABS, ABS_MT_TRACKING_ID, this->currentIDs[i] );
-
-		int16_t x = resX * currentPoints[i].x;
-		int16_t y = resY * currentPoints[i].y;
-
-		if( x >= resX )
-			x = resX - 1;
-		else if( x < 0 )
-			x = 0;
+		if( !this->warnedUntracked )
+			std::cerr << "PointOutput::Uinput: Type B events need a tracker - ignoring points\n";
+		this->warnedUntracked = true;
+		return;
+	}
 
-		if( y >= resY )
-			y = resY - 1;
-		else if( y < 0 )
-			y = 0;
+	std::vector< struct input_event > events;
 
-		addEvent( events, EV_ABS, ABS_MT_POSITION_X, x );
-		addEvent( events, EV_ABS, ABS_MT_POSITION_Y, y );
-	}
+	Clock::time_point now = Clock::now();
 
 	// remove disappeared contacts
-	for( unsigned int i = 0; i < this->previousPoints.size(); i++ )
+	for( unsigned int i = 0; i < trackedPoints.previousPoints.size(); i++ )
 	{
-		if( this->previousIDs[i] < 0 )
+		int id = trackedPoints.previousIDs[i];
+		if( id < 0 || id > maxSlot )
 			continue; // slot disabled
 
-		if( this->previousToCurrent[i] >= 0 )
+		if( trackedPoints.previousToCurrent[i] >= 0 )
 			continue; // still exists in current frame
 
-		addEvent( events, EV_ABS, ABS_MT_SLOT, this->previousIDs[i] );
+		Slot & slot = this->slots[id];
+		if( slot.trackingID < 0 )
+			continue; // already lifted
+
+		this->selectSlot( events, id );
 		addEvent( events, EV_ABS, ABS_MT_TRACKING_ID, -1 );
+		slot.trackingID = -1;
+	}
+
+	// update / add new contacts - only sending what changed since the last report of each slot
+	for( unsigned int i = 0; i < currentPoints.size(); i++ )
+	{
+		int id = trackedPoints.currentIDs[i];
+		if( id < 0 || id > maxSlot )
+			continue;
+
+		Contact contact = this->toContact( currentPoints[i], blobs[i] );
+
+		Slot & slot = this->slots[id];
+		if( slot.trackingID < 0 )
+		{ // new contact
+			this->selectSlot( events, id );
+			addEvent( events, EV_ABS, ABS_MT_TRACKING_ID, id );
+			addEvent( events, EV_ABS, ABS_MT_POSITION_X, contact.x );
+			addEvent( events, EV_ABS, ABS_MT_POSITION_Y, contact.y );
+			addEvent( events, EV_ABS, ABS_MT_TOUCH_MAJOR, contact.touchMajor );
+			addEvent( events, EV_ABS, ABS_MT_PRESSURE, contact.pressure );
+			slot.trackingID = id;
+			slot.x = contact.x;
+			slot.y = contact.y;
+			slot.touchMajor = contact.touchMajor;
+			slot.pressure = contact.pressure;
+			slot.lastReport = now;
+			continue;
+		}
+
+		int dx = std::abs( contact.x - slot.x );
+		int dy = std::abs( contact.y - slot.y );
+		if( !dx && !dy )
+			continue; // nothing changed - size changes alone are not worth an update
+
+		// movements within the deadband are only reported at a limited rate, so stationary contacts still settle on their exact position
+		bool moved = dx > this->settings.deadband || dy > this->settings.deadband;
+		if( !moved && now - slot.lastReport < this->stationaryInterval )
+			continue;
+
+		this->selectSlot( events, id );
+		if( dx )
+			addEvent( events, EV_ABS, ABS_MT_POSITION_X, contact.x );
+		if( dy )
+			addEvent( events, EV_ABS, ABS_MT_POSITION_Y, contact.y );
+		if( contact.touchMajor != slot.touchMajor )
+			addEvent( events, EV_ABS, ABS_MT_TOUCH_MAJOR, contact.touchMajor );
+		if( contact.pressure != slot.pressure )
+			addEvent( events, EV_ABS, ABS_MT_PRESSURE, contact.pressure );
+		slot.x = contact.x;
+		slot.y = contact.y;
+		slot.touchMajor = contact.touchMajor;
+		slot.pressure = contact.pressure;
+		slot.lastReport = now;
 	}
 
 	// if no events to send - we're done
@@ -380,9 +573,6 @@ void Uinput::Impl::outputPointsTypeB( const PointIR::PointArray & currentPoints
 
 	addEvent( events, EV_SYN, SYN_REPORT );
 
-	this->previousPoints = currentPoints;
-	this->previousIDs = this->currentIDs;
-
 	for( const auto & event : events )
 	{
 		ssize_t ret = write( this->fd, &event, sizeof(event) );
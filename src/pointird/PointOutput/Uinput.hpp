@@ -22,7 +22,6 @@
 
 
 #include "APointOutput.hpp"
-#include "../TrackerFactory.hpp"
 
 #include <memory>
 
@@ -36,10 +35,30 @@ public:
 	Uinput( const Uinput & ) = delete; // disable copy constructor
 	Uinput & operator=( const Uinput & other ) = delete; // disable assignment operator
 
-	Uinput( const TrackerFactory * trackerFactory = nullptr );
+	struct Settings
+	{
+		int width = 32768; ///< Number of positions on the horizontal axis.
+		int height = 32768; ///< Number of positions on the vertical axis.
+		int resolution = 0; ///< Axis units per millimeter - 0 if unknown.
+		int fuzz = 0; ///< Passed to the kernel's input filter.
+		int deadband = 0; ///< Suppresses movements of the given size in type B mode.
+		float stationaryInterval = 0.1f; ///< Seconds between updates of contacts moving within the deadband.
+	};
+
+	/// Type B events need the IDs of the processor's tracking stage - contacts with IDs above 511 are ignored.
+	Uinput( bool typeB = false );
+	Uinput( bool typeB, const Settings & settings );
 	virtual ~Uinput();
 
-	virtual void outputPoints( const PointIR::PointArray & pointArray ) override;
+	virtual void outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+	                           const Tracker::TrackedPoints & trackedPoints ) override;
+
+	void setDeadband( int deadband );
+	int getDeadband() const;
+
+	/// Contacts moving within the deadband are updated at most once per interval.
+	void setStationaryInterval( float seconds );
+	float getStationaryInterval() const;
 
 private:
 	class Impl;
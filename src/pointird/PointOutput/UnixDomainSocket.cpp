@@ -19,12 +19,16 @@
 
 #include "UnixDomainSocket.hpp"
 #include "../exceptions.hpp"
+#include "../Tracker/TrackedPoints.hpp"
 
 #include <PointIR/PointArray.h>
+#include <PointIR/PointPacket.h>
 
 #include <list>
+#include <vector>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 #include <string.h>
 #include <unistd.h>
@@ -50,13 +54,98 @@ public:
 	{
 		struct sockaddr_un addr;
 		int fd = 0;
+		uint32_t version = 1; // packet format negotiated with the client
 	};
 	Socket local;
 	std::list< Socket > remotes;
 	unsigned int socketBufferSize = 0;
+
+	uint64_t sequence = 0;
+	std::vector< uint8_t > extendedPacket;
+
+	void receiveRequests();
+	void buildExtendedPacket( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+	                          const Tracker::TrackedPoints & trackedPoints );
 };
 
 
+// reads the packet versions the clients asked for - requests may be sent at any time
+void UnixDomainSocket::Impl::receiveRequests()
+{
+	for( auto & remote : this->remotes )
+	{
+		while( true )
+		{
+			PointIR_PointPacketRequest request;
+			ssize_t received = recv( remote.fd, &request, sizeof(request), MSG_DONTWAIT );
+			if( sizeof(request) != received )
+				break; // nothing left - errors and closed connections are handled when sending
+			if( POINTIR_POINTPACKET_MAGIC != request.magic || !request.version )
+				continue;
+			remote.version = std::min< uint32_t >( request.version, POINTIR_POINTPACKET_VERSION );
+		}
+	}
+}
+
+
+// current contacts followed by the tracked ones lifted since the last frame
+void UnixDomainSocket::Impl::buildExtendedPacket( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+                                                  const Tracker::TrackedPoints & trackedPoints )
+{
+	bool tracked = trackedPoints.isValid( pointArray );
+	uint32_t count = pointArray.size();
+	if( tracked )
+	{
+		for( unsigned int i = 0; i < trackedPoints.previousToCurrent.size(); i++ )
+			if( trackedPoints.previousToCurrent[i] < 0 && trackedPoints.previousIDs[i] >= 0 )
+				count++;
+	}
+
+	this->extendedPacket.resize( sizeof(PointIR_PointPacketHeader) + count * sizeof(PointIR_PointPacketPoint) );
+	PointIR_PointPacketHeader * header = reinterpret_cast< PointIR_PointPacketHeader * >( this->extendedPacket.data() );
+	header->magic = POINTIR_POINTPACKET_MAGIC;
+	header->version = POINTIR_POINTPACKET_VERSION;
+	header->headerSize = sizeof(PointIR_PointPacketHeader);
+	header->pointSize = sizeof(PointIR_PointPacketPoint);
+	header->count = count;
+	header->sequence = trackedPoints.frameNumber ? trackedPoints.frameNumber : this->sequence;
+	header->timestamp = trackedPoints.frameTimestamp;
+
+	PointIR_PointPacketPoint * point = reinterpret_cast< PointIR_PointPacketPoint * >( this->extendedPacket.data() + sizeof(PointIR_PointPacketHeader) );
+	for( unsigned int i = 0; i < pointArray.size(); i++, point++ )
+	{
+		point->x = pointArray[i].x;
+		point->y = pointArray[i].y;
+		point->id = tracked ? trackedPoints.currentIDs[i] : -1;
+		if( point->id < 0 )
+			point->state = POINTIR_POINTSTATE_UNTRACKED;
+		else if( trackedPoints.currentStates[i] == Tracker::TrackedPoints::DOWN )
+			point->state = POINTIR_POINTSTATE_DOWN;
+		else
+			point->state = POINTIR_POINTSTATE_MOVE;
+		point->width = blobs[i].width;
+		point->height = blobs[i].height;
+		point->angle = blobs[i].angle;
+		point->area = blobs[i].area;
+		point->intensity = blobs[i].intensity;
+	}
+	if( !tracked )
+		return;
+	for( unsigned int i = 0; i < trackedPoints.previousToCurrent.size(); i++ )
+	{
+		// untracked points can't be lifted - no consumer knows them as a contact
+		if( trackedPoints.previousToCurrent[i] >= 0 || trackedPoints.previousIDs[i] < 0 )
+			continue;
+		memset( point, 0, sizeof(*point) );
+		point->x = trackedPoints.previousPoints[i].x;
+		point->y = trackedPoints.previousPoints[i].y;
+		point->id = trackedPoints.previousIDs[i];
+		point->state = POINTIR_POINTSTATE_UP;
+		point++;
+	}
+}
+
+
 static void unlinkSocket( const std::string & socketPath )
 {
 	struct stat st;
@@ -128,10 +217,22 @@ UnixDomainSocket::~UnixDomainSocket()
 }
 
 
-void UnixDomainSocket::outputPoints( const PointIR::PointArray & pointArray )
+void UnixDomainSocket::outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+                                     const Tracker::TrackedPoints & trackedPoints )
 {
-	const PointIR_PointArray * packet = static_cast< const PointIR_PointArray * >( pointArray );
-	size_t packetSize = sizeof(PointIR_PointArray) + packet->count * sizeof(PointIR_Point);
+	const PointIR_PointArray * legacyPacket = static_cast< const PointIR_PointArray * >( pointArray );
+	size_t legacyPacketSize = sizeof(PointIR_PointArray) + legacyPacket->count * sizeof(PointIR_Point);
+
+	this->pImpl->sequence++;
+	this->pImpl->receiveRequests();
+
+	// only build the extended packet if anybody asked for it
+	bool extended = false;
+	for( const auto & remote : this->pImpl->remotes )
+		extended = extended || remote.version >= 2;
+	if( extended )
+		this->pImpl->buildExtendedPacket( pointArray, blobs, trackedPoints );
+	size_t packetSize = std::max( legacyPacketSize, extended ? this->pImpl->extendedPacket.size() : 0 );
 
 	// resize socket buffers if needed - doesn't seem necessary for SOCK_SEQPACKET
 	if( this->pImpl->socketBufferSize < packetSize )
@@ -172,6 +273,13 @@ void UnixDomainSocket::outputPoints( const PointIR::PointArray & pointArray )
 	// send points packet - removing remotes on the fly if disconnected
 	for( auto it = this->pImpl->remotes.begin(); it != this->pImpl->remotes.end(); )
 	{
+		const void * packet = legacyPacket;
+		size_t packetSize = legacyPacketSize;
+		if( it->version >= 2 )
+		{
+			packet = this->pImpl->extendedPacket.data();
+			packetSize = this->pImpl->extendedPacket.size();
+		}
 		ssize_t sent = send( it->fd, packet, packetSize, MSG_NOSIGNAL );
 		if( -1 == sent )
 		{
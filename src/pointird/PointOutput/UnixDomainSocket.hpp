@@ -40,7 +40,8 @@ public:
 	UnixDomainSocket( const std::string & socketPath );
 	virtual ~UnixDomainSocket();
 
-	virtual void outputPoints( const PointIR::PointArray & pointArray ) override;
+	virtual void outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+	                           const Tracker::TrackedPoints & trackedPoints ) override;
 
 	const std::string & getSocketPath() const { return this->socketPath; }
 
@@ -20,7 +20,7 @@
 
 #include "Win8TouchInjection.hpp"
 #include "../exceptions.hpp"
-#include "../TrackerFactory.hpp"
+#include "../Tracker/TrackedPoints.hpp"
 
 #include <PointIR/PointArray.h>
 
@@ -57,12 +57,7 @@ public:
 	InitializeTouchInjectionPtr InitializeTouchInjection = nullptr;
 	InjectTouchInputPtr InjectTouchInput = nullptr;
 
-	Tracker::ATracker * tracker = nullptr;
-	PointIR::PointArray previousPoints;
-	std::vector< int > previousIDs;
-	std::vector< int > currentIDs;
-	std::vector< int > currentToPrevious;
-	std::vector< int > previousToCurrent;
+	bool warnedUntracked = false;
 };
 
 
@@ -81,21 +76,18 @@ bool Win8TouchInjection::isAvailable()
 }
 
 
-Win8TouchInjection::Win8TouchInjection( const TrackerFactory & trackerFactory ) :
+Win8TouchInjection::Win8TouchInjection() :
 	pImpl( new Impl )
 {
-	this->pImpl->tracker = trackerFactory.newTracker( MAX_TOUCH_COUNT );
-
-	if( !this->pImpl->InitializeTouchInjection( this->pImpl->tracker->getMaxID(), TOUCH_FEEDBACK_DEFAULT ) )
+	if( !this->pImpl->InitializeTouchInjection( MAX_TOUCH_COUNT, TOUCH_FEEDBACK_DEFAULT ) )
 		throw RUNTIME_ERROR( "InitializeTouchInjection failure. GetLastError=" + std::to_string(GetLastError()) );
 
-	std::cout << "PointOutput::Win8TouchInjection: initialized for " << this->pImpl->tracker->getMaxID() << " touch points\n";
+	std::cout << "PointOutput::Win8TouchInjection: initialized for " << MAX_TOUCH_COUNT << " touch points\n";
 }
 
 
 Win8TouchInjection::~Win8TouchInjection()
 {
-	delete this->pImpl->tracker;
 }
 
 
@@ -113,11 +105,23 @@ static void clampToScreen( POINT & p, int screenWidth, int screenHeight )
 }
 
 
-void Win8TouchInjection::outputPoints( const PointIR::PointArray & currentPoints )
+// pointer IDs have to stay below the number of contacts given to InitializeTouchInjection
+static bool isInjectable( int id )
+{
+	return id >= 0 && id < MAX_TOUCH_COUNT;
+}
+
+
+void Win8TouchInjection::outputPoints( const PointIR::PointArray & currentPoints, const std::vector< PointIR::Blob > &,
+                                       const Tracker::TrackedPoints & trackedPoints )
 {
-	this->pImpl->tracker->assignIDs( this->pImpl->previousPoints, this->pImpl->previousIDs,
-	                                currentPoints, this->pImpl->currentIDs,
-	                                this->pImpl->previousToCurrent, this->pImpl->currentToPrevious );
+	if( !trackedPoints.isValid( currentPoints ) )
+	{
+		if( !this->pImpl->warnedUntracked )
+			std::cerr << "PointOutput::Win8TouchInjection: Need a tracker - ignoring points\n";
+		this->pImpl->warnedUntracked = true;
+		return;
+	}
 
 	int screenWidth = GetSystemMetrics( SM_CXSCREEN );
 	int screenHeight = GetSystemMetrics( SM_CYSCREEN );
@@ -126,12 +130,12 @@ void Win8TouchInjection::outputPoints( const PointIR::PointArray & currentPoints
 	infos.reserve( currentPoints.size() );
 
 	// remove points not found in the current frame
-	for( unsigned int i = 0; i < this->pImpl->previousToCurrent.size(); i++ )
+	for( unsigned int i = 0; i < trackedPoints.previousToCurrent.size(); i++ )
 	{
-		if( this->pImpl->previousIDs[i] < 0 )
+		if( !isInjectable( trackedPoints.previousIDs[i] ) )
 			continue; // slot disabled
 
-		if( this->pImpl->previousToCurrent[i] >= 0 )
+		if( trackedPoints.previousToCurrent[i] >= 0 )
 			continue; // still exists in current frame
 
 		POINTER_TOUCH_INFO info = {0};
@@ -139,9 +143,9 @@ void Win8TouchInjection::outputPoints( const PointIR::PointArray & currentPoints
 		info.touchMask = TOUCH_MASK_NONE;
 		info.pointerInfo.pointerFlags = POINTER_FLAG_UP;
 		info.pointerInfo.pointerType = PT_TOUCH;
-		info.pointerInfo.pointerId = this->pImpl->previousIDs[i];
-		info.pointerInfo.ptPixelLocation.x = this->pImpl->previousPoints[i].x * screenWidth;
-		info.pointerInfo.ptPixelLocation.y = this->pImpl->previousPoints[i].y * screenHeight;
+		info.pointerInfo.pointerId = trackedPoints.previousIDs[i];
+		info.pointerInfo.ptPixelLocation.x = trackedPoints.previousPoints[i].x * screenWidth;
+		info.pointerInfo.ptPixelLocation.y = trackedPoints.previousPoints[i].y * screenHeight;
 		clampToScreen( info.pointerInfo.ptPixelLocation, screenWidth, screenHeight );
 
 		infos.push_back( info );
@@ -153,7 +157,7 @@ void Win8TouchInjection::outputPoints( const PointIR::PointArray & currentPoints
 	{
 		for( unsigned int i = 0; i < currentPoints.size(); i++ )
 		{
-			if( this->pImpl->currentIDs[i] < 0 )
+			if( !isInjectable( trackedPoints.currentIDs[i] ) )
 				continue;
 
 			POINTER_TOUCH_INFO info = {0};
@@ -161,13 +165,13 @@ void Win8TouchInjection::outputPoints( const PointIR::PointArray & currentPoints
 			info.touchMask = TOUCH_MASK_NONE;
 
 			info.pointerInfo.pointerFlags = POINTER_FLAG_INRANGE | POINTER_FLAG_INCONTACT;
-			if( this->pImpl->currentToPrevious[i] < 0 ) // not in previous frame - has to be new
+			if( trackedPoints.currentStates[i] == Tracker::TrackedPoints::DOWN ) // not in previous frame - has to be new
 				info.pointerInfo.pointerFlags |= POINTER_FLAG_DOWN;
 			else // normal update - point just moved
 				info.pointerInfo.pointerFlags |= POINTER_FLAG_UPDATE;
 
 			info.pointerInfo.pointerType = PT_TOUCH;
-			info.pointerInfo.pointerId = this->pImpl->currentIDs[i];
+			info.pointerInfo.pointerId = trackedPoints.currentIDs[i];
 			info.pointerInfo.ptPixelLocation.x = currentPoints[i].x * screenWidth;;
 			info.pointerInfo.ptPixelLocation.y = currentPoints[i].y * screenHeight;
 			clampToScreen( info.pointerInfo.ptPixelLocation, screenWidth, screenHeight );
@@ -182,7 +186,4 @@ void Win8TouchInjection::outputPoints( const PointIR::PointArray & currentPoints
 		if( !this->pImpl->InjectTouchInput( infos.size(), infos.data() ) )
 			std::cerr << "Win8TouchInjection: InjectTouchInput failed with error " << GetLastError() << "\n";
 	}
-
-	this->pImpl->previousPoints = currentPoints;
-	this->pImpl->previousIDs = this->pImpl->currentIDs;
 }
@@ -22,7 +22,6 @@
 
 
 #include "APointOutput.hpp"
-#include "../TrackerFactory.hpp"
 
 #include <memory>
 
@@ -36,10 +35,12 @@ public:
 	Win8TouchInjection( const Win8TouchInjection & ) = delete; // disable copy constructor
 	Win8TouchInjection & operator=( const Win8TouchInjection & other ) = delete; // disable assignment operator
 
-	Win8TouchInjection( const TrackerFactory & trackerFactory );
+	/// Needs the IDs of the processor's tracking stage.
+	Win8TouchInjection();
 	virtual ~Win8TouchInjection();
 
-	virtual void outputPoints( const PointIR::PointArray & pointArray ) override;
+	virtual void outputPoints( const PointIR::PointArray & pointArray, const std::vector< PointIR::Blob > & blobs,
+	                           const Tracker::TrackedPoints & trackedPoints ) override;
 
 	static bool isAvailable();
 private:
@@ -21,14 +21,19 @@
 
 
 #include "Processor.hpp"
+#include "Camera.hpp"
+#include "PointBatch.hpp"
 
 #include "Capture/ACapture.hpp"
 #include "FrameOutput/AFrameOutput.hpp"
 #include "PointDetector/APointDetector.hpp"
 #include "Unprojector/AUnprojector.hpp"
 #include "Unprojector/AAutoUnprojector.hpp"
+#include "Unprojector/ScreenMask.hpp"
 #include "PointFilter/APointFilter.hpp"
 #include "PointOutput/APointOutput.hpp"
+#include "Tracker/ATracker.hpp"
+#include "Tracker/TrackedPoints.hpp"
 
 #include <PointIR/Point.h>
 
@@ -36,6 +41,13 @@
 
 #include <iostream>
 #include <set>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
 
 #ifdef POINTIR_PROCESSOR_BENCHMARK
 	#include <unistd.h>
@@ -75,14 +87,71 @@
 class Processor::Impl
 {
 public:
-	Impl( Processor & processor ) : processor(processor) {}
+	Impl( Processor & processor ) : activeConfiguration( new Configuration ), processor(processor) {}
+	~Impl() { delete this->pendingConfiguration.load(); }
 
-	PointFilter::APointFilter * filter = nullptr;
-
-	std::set< FrameOutput::AFrameOutput * > frameOutputs;
-	std::set< PointOutput::APointOutput * > pointOutputs;
-	bool frameOutputEnabled = true;
-	bool pointOutputEnabled = true;
+	/// Everything a frame is processed with that may be changed by controllers.
+	struct Configuration
+	{
+		PointFilter::APointFilter * filter = nullptr;
+		Tracker::ATracker * tracker = nullptr;
+		std::set< FrameOutput::AFrameOutput * > frameOutputs;
+		std::set< PointOutput::APointOutput * > pointOutputs;
+		bool frameOutputEnabled = true;
+		bool pointOutputEnabled = true;
+		std::set< Camera * > cameras;
+		float cameraMergeDistance = 0.02f;
+		uint64_t cameraSyncWindow = 50000;
+		bool cropToScreen = false;
+		bool maskToScreen = false;
+		float screenMargin = 0.02f;
+	};
+
+	// Control calls change "configuration" and publish a copy in "pendingConfiguration", which is adopted at the start
+	// of the next frame. So the processing never waits for a control call and a frame is always processed with one configuration.
+	std::mutex configurationMutex;
+	Configuration configuration;
+	std::atomic< Configuration * > pendingConfiguration { nullptr };
+	std::unique_ptr< Configuration > activeConfiguration; // only accessed by processFrame
+	std::atomic< bool > inFrame { false };
+	std::atomic< std::thread::id > processingThread;
+	// control calls waiting for the end of a frame - the processing only locks to wake them if there are any
+	std::atomic< unsigned int > frameEndWaiters { 0 };
+	std::mutex frameEndMutex;
+	std::condition_variable frameEnd;
+
+	PointIR::PointArray cameraPointArray;
+	std::vector< PointIR::Blob > cameraBlobs;
+	PointBatch unprojectBatch;
+	// the detected points of the frame, from filtering on - written back to "pointArray" for the tracker and the outputs
+	PointBatch pointBatch;
+
+	// what the region of the capture was last derived from - only accessed by processFrame
+	bool cropped = false;
+	unsigned int croppedGeneration = 0;
+	float croppedScreenMargin = 0.0f;
+
+	// the mask of the screen in the processed frame and what it was built from - only accessed by processFrame
+	struct ScreenMaskSource
+	{
+		unsigned int generation, width, height, x, y;
+		float margin;
+		bool operator==( const ScreenMaskSource & other ) const
+		{
+			return generation == other.generation && width == other.width && height == other.height
+			    && x == other.x && y == other.y && margin == other.margin;
+		}
+	};
+	Unprojector::ScreenMask screenMask;
+	ScreenMaskSource screenMaskSource = {};
+	bool hasScreenMask = false;
+
+	Tracker::ATracker * lastTracker = nullptr;
+	Tracker::TrackedPoints trackedPoints;
+	std::chrono::steady_clock::time_point lastTrackingTime;
+	// the tracking since the outputs last got points, while they are disabled
+	Tracker::TrackedPoints undeliveredTrackedPoints;
+	bool hasUndeliveredTrackedPoints = false;
 
 	std::set< ACalibrationListener * > calibrationListeners;
 	bool calibrating = false;
@@ -91,6 +160,146 @@ public:
 	static const unsigned int maxCalibrationTries = 3;
 	unsigned int calibrationTry = 0;
 
+	/// Applies the change to the configuration and publishes it, unless the change returns false.
+	/// Returns when the processing doesn't use the previous configuration anymore, so removed modules may be destroyed.
+	template< typename Change > bool configure( Change change )
+	{
+		{
+			std::lock_guard< std::mutex > lock( this->configurationMutex );
+			if( !change( this->configuration ) )
+				return false;
+			// a replaced pending configuration has never been seen by the processing
+			delete this->pendingConfiguration.exchange( new Configuration( this->configuration ) );
+		}
+		// can't wait for the current frame if called while processing it - e.g. from a calibration listener
+		if( std::this_thread::get_id() == this->processingThread.load() )
+			return true;
+		this->frameEndWaiters++;
+		{
+			std::unique_lock< std::mutex > lock( this->frameEndMutex );
+			this->frameEnd.wait( lock, [this] { return !this->inFrame.load() || !this->pendingConfiguration.load(); } );
+		}
+		this->frameEndWaiters--;
+		return true;
+	}
+
+	void endFrame()
+	{
+		this->inFrame = false;
+		if( this->frameEndWaiters.load() )
+		{
+			// taking the lock ensures a waiter has either seen the frame end or is waiting for the notification
+			{ std::lock_guard< std::mutex > lock( this->frameEndMutex ); }
+			this->frameEnd.notify_all();
+		}
+	}
+
+	const Configuration & adoptConfiguration()
+	{
+		if( Configuration * pending = this->pendingConfiguration.exchange( nullptr ) )
+			this->activeConfiguration.reset( pending );
+		return *(this->activeConfiguration);
+	}
+
+	/// Adds the points of another camera - points closer than the merge distance to one of the existing points are taken as the same contact.
+	static void mergePoints( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs,
+	                         const PointIR::PointArray & otherPointArray, const std::vector< PointIR::Blob > & otherBlobs, float mergeDistance )
+	{
+		PointIR::PointArray::size_type existing = pointArray.size();
+		for( PointIR::PointArray::size_type o = 0; o < otherPointArray.size(); o++ )
+		{
+			const PointIR::Point & other = otherPointArray[o];
+			const PointIR::Blob & otherBlob = otherBlobs[o];
+
+			// only compare with points of the other cameras - close contacts seen by the same camera are distinct
+			PointIR::PointArray::size_type nearest = existing;
+			float nearestDistance = mergeDistance * mergeDistance;
+			for( PointIR::PointArray::size_type i = 0; i < existing; i++ )
+			{
+				PointIR::Point delta = pointArray[i] - other;
+				float distance = delta.x * delta.x + delta.y * delta.y;
+				if( distance <= nearestDistance )
+				{
+					nearest = i;
+					nearestDistance = distance;
+				}
+			}
+
+			if( nearest == existing )
+			{
+				pointArray.resizeIfNeeded( pointArray.size() + 1 );
+				pointArray.back() = other;
+				blobs.push_back( otherBlob );
+				continue;
+			}
+
+			// average weighted by area - the camera seeing more of the contact is probably closer
+			PointIR::Point & point = pointArray[nearest];
+			PointIR::Blob & blob = blobs[nearest];
+			float weight = blob.area + otherBlob.area;
+			float otherWeight = weight > 0.0f ? otherBlob.area / weight : 0.5f;
+			point = point * ( 1.0f - otherWeight ) + other * otherWeight;
+			float intensity = std::max( blob.intensity, otherBlob.intensity );
+			if( otherBlob.area > blob.area )
+				blob = otherBlob;
+			blob.intensity = intensity;
+		}
+	}
+
+	/// Restricts the capture to the screen with some margin around it - or to the whole image while calibrating.
+	void updateRegion( const Configuration & configuration )
+	{
+		Capture::ACapture & capture = this->processor.capture;
+		Unprojector::AUnprojector & unprojector = this->processor.unprojector;
+
+		// the size of the whole image is only known after the first frame
+		bool crop = configuration.cropToScreen && !this->calibrating && this->processor.fullFrameWidth && this->processor.fullFrameHeight;
+		unsigned int generation = unprojector.getCalibrationGeneration();
+		if( crop == this->cropped && ( !crop || ( generation == this->croppedGeneration && configuration.screenMargin == this->croppedScreenMargin ) ) )
+			return;
+		this->cropped = crop;
+		this->croppedGeneration = generation;
+		this->croppedScreenMargin = configuration.screenMargin;
+
+		Capture::ACapture::Region region;
+		PointIR::Point min, max;
+		if( crop && unprojector.getScreenBounds( min, max ) )
+		{
+			float margin = configuration.screenMargin;
+			float left = std::max( 0.0f, min.x / (float)this->processor.fullFrameWidth - margin );
+			float top = std::max( 0.0f, min.y / (float)this->processor.fullFrameHeight - margin );
+			float right = std::min( 1.0f, max.x / (float)this->processor.fullFrameWidth + margin );
+			float bottom = std::min( 1.0f, max.y / (float)this->processor.fullFrameHeight + margin );
+			if( right > left && bottom > top )
+			{
+				region.x = left;
+				region.y = top;
+				region.width = right - left;
+				region.height = bottom - top;
+			}
+		}
+		if( !capture.setRegion( region ) )
+			std::cerr << "Processor: Capture does not support cropping - using the whole image.\n";
+	}
+
+	/// Rebuilds the mask of the screen if it changed - false if there is no screen to mask, e.g. when not calibrated.
+	bool updateScreenMask( const Configuration & configuration )
+	{
+		const Processor & processor = this->processor;
+		ScreenMaskSource source = {
+			processor.unprojector.getCalibrationGeneration(), processor.frame.getWidth(), processor.frame.getHeight(),
+			processor.frameX, processor.frameY, configuration.screenMargin
+		};
+		if( source == this->screenMaskSource )
+			return this->hasScreenMask;
+		this->screenMaskSource = source;
+
+		float margin = configuration.screenMargin * (float)( processor.fullFrameWidth + processor.fullFrameHeight ) / 2.0f;
+		this->hasScreenMask = processor.unprojector.getScreenMask( this->screenMask,
+			processor.frame.getWidth(), processor.frame.getHeight(), processor.frameX, processor.frameY, margin );
+		return this->hasScreenMask;
+	}
+
 	void endCalibration( bool result )
 	{
 		this->calibrationSucceeded = result;
@@ -130,13 +339,15 @@ Processor::~Processor()
 
 std::set< FrameOutput::AFrameOutput * > Processor::getFrameOutputs()
 {
-	return this->pImpl->frameOutputs;
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.frameOutputs;
 }
 
 
 std::set< PointOutput::APointOutput * > Processor::getPointOutputs()
 {
-	return this->pImpl->pointOutputs;
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.pointOutputs;
 }
 
 
@@ -146,6 +357,8 @@ void Processor::start()
 		return;
 
 	this->capture.start();
+	for( Camera * camera : this->getCameras() )
+		camera->start();
 }
 
 
@@ -154,6 +367,8 @@ void Processor::stop()
 	if( !this->isProcessing() )
 		return;
 	this->capture.stop();
+	for( Camera * camera : this->getCameras() )
+		camera->stop();
 }
 
 
@@ -173,6 +388,17 @@ void Processor::processFrame()
 	TIME( total );
 	TIMESTART( total );
 
+	this->pImpl->processingThread = std::this_thread::get_id();
+	this->pImpl->inFrame = true;
+	const Impl::Configuration & configuration = this->pImpl->adoptConfiguration();
+	struct FrameEnd
+	{
+		Impl & impl;
+		~FrameEnd() { impl.endFrame(); }
+	} frameEnd { *(this->pImpl) };
+
+	this->pImpl->updateRegion( configuration );
+
 	TIME( advanceFrame );
 	TIMESTART( advanceFrame );
 	if( !this->capture.advanceFrame( true, 1.0f ) )
@@ -182,6 +408,8 @@ void Processor::processFrame()
 		return;
 	}
 	TIMESTOP( "advanceFrame", advanceFrame );
+	// the frame just became available - as close to its capture time as it gets here
+	uint64_t timestamp = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
 	TIME( retrieveFrame );
 	TIMESTART( retrieveFrame );
 	if( !this->capture.retrieveFrame( this->frame ) )
@@ -191,12 +419,21 @@ void Processor::processFrame()
 		return;
 	}
 	TIMESTOP( "retrieveFrame", retrieveFrame );
+	this->frameNumber++;
+	this->frameTimestamp = timestamp;
+
+	// locate the frame in the whole image
+	Capture::ACapture::Region region = this->capture.getRegion();
+	this->fullFrameWidth = std::lround( this->frame.getWidth() / region.width );
+	this->fullFrameHeight = std::lround( this->frame.getHeight() / region.height );
+	this->frameX = std::lround( region.x * this->fullFrameWidth );
+	this->frameY = std::lround( region.y * this->fullFrameHeight );
 
 	TIME( outputFrame );
 	TIMESTART( outputFrame );
-	if( this->pImpl->frameOutputEnabled )
+	if( configuration.frameOutputEnabled )
 	{
-		for( FrameOutput::AFrameOutput * output : this->pImpl->frameOutputs )
+		for( FrameOutput::AFrameOutput * output : configuration.frameOutputs )
 		output->outputFrame( this->frame );
 	}
 	TIMESTOP( "outputFrame", outputFrame );
@@ -238,26 +475,90 @@ void Processor::processFrame()
 	{
 		TIME( detectPoints );
 		TIMESTART( detectPoints );
-		this->detector.detect( this->pointArray, this->frame );
+		if( configuration.maskToScreen && this->pImpl->updateScreenMask( configuration ) )
+			this->detector.detect( this->pointArray, this->blobs, this->frame, this->pImpl->screenMask );
+		else
+			this->detector.detect( this->pointArray, this->blobs, this->frame );
+		// the calibration refers to the whole image
+		if( this->frameX || this->frameY )
+		{
+			for( PointIR::Point & point : this->pointArray )
+				point += PointIR::Point( (float)this->frameX, (float)this->frameY );
+		}
 		TIMESTOP( "detectPoints", detectPoints );
 
 		TIME( unprojectPoints );
 		TIMESTART( unprojectPoints );
-		this->unprojector.unproject( this->pointArray );
+		this->unprojector.unproject( this->pointArray, this->blobs, this->pImpl->unprojectBatch );
 		TIMESTOP( "unprojectPoints", unprojectPoints );
 
+		TIME( mergeCameras );
+		TIMESTART( mergeCameras );
+		for( Camera * camera : configuration.cameras )
+		{
+			uint64_t timestamp;
+			if( !camera->retrievePoints( this->pImpl->cameraPointArray, this->pImpl->cameraBlobs, timestamp ) )
+				continue;
+			// drop points too far apart in time - e.g. of a stalled camera
+			uint64_t age = timestamp > this->frameTimestamp ? timestamp - this->frameTimestamp : this->frameTimestamp - timestamp;
+			if( age > configuration.cameraSyncWindow )
+				continue;
+			Impl::mergePoints( this->pointArray, this->blobs, this->pImpl->cameraPointArray, this->pImpl->cameraBlobs, configuration.cameraMergeDistance );
+		}
+		TIMESTOP( "mergeCameras", mergeCameras );
+
 		TIME( filterPoints );
 		TIMESTART( filterPoints );
-		if( this->pImpl->filter )
-			this->pImpl->filter->filterPoints( this->pointArray );
+		this->pImpl->pointBatch.assign( this->pointArray, this->blobs, this->frameTimestamp );
+		if( configuration.filter )
+		{
+			configuration.filter->filterPoints( this->pImpl->pointBatch, this->blobs );
+			this->pImpl->pointBatch.toPointArray( this->pointArray );
+		}
 		TIMESTOP( "filterPoints", filterPoints );
 
+		TIME( trackPoints );
+		TIMESTART( trackPoints );
+		if( configuration.tracker != this->pImpl->lastTracker )
+		{
+			this->pImpl->lastTracker = configuration.tracker;
+			this->pImpl->trackedPoints = Tracker::TrackedPoints();
+		}
+		if( configuration.tracker )
+		{
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			float dt = std::chrono::duration< float >( now - this->pImpl->lastTrackingTime ).count();
+			this->pImpl->lastTrackingTime = now;
+			this->pImpl->trackedPoints.update( *(configuration.tracker), this->pointArray, dt );
+			std::copy( this->pImpl->trackedPoints.currentIDs.begin(), this->pImpl->trackedPoints.currentIDs.end(), this->pImpl->pointBatch.id.begin() );
+		}
+		// outputs may send the points later on their own threads - they must not read the processor's frame number then
+		this->pImpl->trackedPoints.frameNumber = this->frameNumber;
+		this->pImpl->trackedPoints.frameTimestamp = this->frameTimestamp;
+		TIMESTOP( "trackPoints", trackPoints );
+
 		TIME( outputPoints );
 		TIMESTART( outputPoints );
-		if( this->pImpl->pointOutputEnabled )
+		if( configuration.pointOutputEnabled )
+		{
+			// once enabled again, the outputs get everything that happened since they last got points
+			const Tracker::TrackedPoints * trackedPoints = &this->pImpl->trackedPoints;
+			if( this->pImpl->hasUndeliveredTrackedPoints && configuration.tracker )
+			{
+				this->pImpl->undeliveredTrackedPoints.append( this->pImpl->trackedPoints );
+				trackedPoints = &this->pImpl->undeliveredTrackedPoints;
+			}
+			this->pImpl->hasUndeliveredTrackedPoints = false;
+			for( PointOutput::APointOutput * output : configuration.pointOutputs )
+				output->outputPoints( this->pointArray, this->blobs, *trackedPoints );
+		}
+		else if( configuration.tracker )
 		{
-			for( PointOutput::APointOutput * output : this->pImpl->pointOutputs )
-				output->outputPoints( this->pointArray );
+			if( this->pImpl->hasUndeliveredTrackedPoints )
+				this->pImpl->undeliveredTrackedPoints.append( this->pImpl->trackedPoints );
+			else
+				this->pImpl->undeliveredTrackedPoints = this->pImpl->trackedPoints;
+			this->pImpl->hasUndeliveredTrackedPoints = true;
 		}
 		TIMESTOP( "outputPoints", outputPoints );
 
@@ -317,59 +618,187 @@ bool Processor::isCalibrationSucceeded() const
 
 bool Processor::addFrameOutput( FrameOutput::AFrameOutput * output )
 {
-	return this->pImpl->frameOutputs.insert( output ).second;
+	return this->pImpl->configure( [output] ( Impl::Configuration & configuration )
+		{ return bool( configuration.frameOutputs.insert( output ).second ); } );
 }
 
 
 bool Processor::removeFrameOutput( FrameOutput::AFrameOutput * output )
 {
-	return this->pImpl->frameOutputs.erase( output );
+	return this->pImpl->configure( [output] ( Impl::Configuration & configuration )
+		{ return bool( configuration.frameOutputs.erase( output ) ); } );
 }
 
 
 bool Processor::addPointOutput( PointOutput::APointOutput * output )
 {
-	return this->pImpl->pointOutputs.insert( output ).second;
+	return this->pImpl->configure( [output] ( Impl::Configuration & configuration )
+		{ return bool( configuration.pointOutputs.insert( output ).second ); } );
 }
 
 
 bool Processor::removePointOutput( PointOutput::APointOutput * output )
 {
-	return this->pImpl->pointOutputs.erase( output );
+	return this->pImpl->configure( [output] ( Impl::Configuration & configuration )
+		{ return bool( configuration.pointOutputs.erase( output ) ); } );
 }
 
 
 void Processor::setFrameOutputEnabled( bool enable )
 {
-	this->pImpl->frameOutputEnabled = enable;
+	this->pImpl->configure( [enable] ( Impl::Configuration & configuration )
+		{ configuration.frameOutputEnabled = enable; return true; } );
 }
 
 
 bool Processor::isFrameOutputEnabled() const
 {
-	return this->pImpl->frameOutputEnabled;
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.frameOutputEnabled;
 }
 
 
 void Processor::setPointOutputEnabled( bool enable )
 {
-	this->pImpl->pointOutputEnabled = enable;
+	this->pImpl->configure( [enable] ( Impl::Configuration & configuration )
+		{ configuration.pointOutputEnabled = enable; return true; } );
 }
 
 
 bool Processor::isPointOutputEnabled() const
 {
-	return this->pImpl->pointOutputEnabled;
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.pointOutputEnabled;
 }
 
 
 void Processor::setPointFilter( PointFilter::APointFilter * pointFilter )
 {
-	this->pImpl->filter = pointFilter;
+	this->pImpl->configure( [pointFilter] ( Impl::Configuration & configuration )
+		{ configuration.filter = pointFilter; return true; } );
 }
 
 
 PointFilter::APointFilter * Processor::getPointFilter() const
 {
-	return this->pImpl->filter;
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.filter;
+}
+
+
+void Processor::setTracker( Tracker::ATracker * tracker )
+{
+	this->pImpl->configure( [tracker] ( Impl::Configuration & configuration )
+		{ configuration.tracker = tracker; return true; } );
+}
+
+
+Tracker::ATracker * Processor::getTracker() const
+{
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.tracker;
+}
+
+
+const Tracker::TrackedPoints & Processor::getTrackedPoints() const
+{
+	return this->pImpl->trackedPoints;
+}
+
+
+bool Processor::addCamera( Camera * camera )
+{
+	if( !this->pImpl->configure( [camera] ( Impl::Configuration & configuration )
+		{ return configuration.cameras.insert( camera ).second; } ) )
+		return false;
+	if( this->isProcessing() )
+		camera->start();
+	return true;
+}
+
+
+bool Processor::removeCamera( Camera * camera )
+{
+	if( !this->pImpl->configure( [camera] ( Impl::Configuration & configuration )
+		{ return bool( configuration.cameras.erase( camera ) ); } ) )
+		return false;
+	camera->stop();
+	return true;
+}
+
+
+std::set< Camera * > Processor::getCameras()
+{
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.cameras;
+}
+
+
+void Processor::setCameraMergeDistance( float distance )
+{
+	this->pImpl->configure( [distance] ( Impl::Configuration & configuration )
+		{ configuration.cameraMergeDistance = distance; return true; } );
+}
+
+
+float Processor::getCameraMergeDistance() const
+{
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.cameraMergeDistance;
+}
+
+
+void Processor::setCameraSyncWindow( uint64_t microseconds )
+{
+	this->pImpl->configure( [microseconds] ( Impl::Configuration & configuration )
+		{ configuration.cameraSyncWindow = microseconds; return true; } );
+}
+
+
+uint64_t Processor::getCameraSyncWindow() const
+{
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.cameraSyncWindow;
+}
+
+
+void Processor::setCropToScreen( bool enable )
+{
+	this->pImpl->configure( [enable] ( Impl::Configuration & configuration )
+		{ configuration.cropToScreen = enable; return true; } );
+}
+
+
+bool Processor::isCropToScreen() const
+{
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.cropToScreen;
+}
+
+
+void Processor::setMaskToScreen( bool enable )
+{
+	this->pImpl->configure( [enable] ( Impl::Configuration & configuration )
+		{ configuration.maskToScreen = enable; return true; } );
+}
+
+
+bool Processor::isMaskToScreen() const
+{
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.maskToScreen;
+}
+
+
+void Processor::setScreenMargin( float margin )
+{
+	this->pImpl->configure( [margin] ( Impl::Configuration & configuration )
+		{ configuration.screenMargin = margin; return true; } );
+}
+
+
+float Processor::getScreenMargin() const
+{
+	std::lock_guard< std::mutex > lock( this->pImpl->configurationMutex );
+	return this->pImpl->configuration.screenMargin;
 }
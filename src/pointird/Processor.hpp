@@ -23,11 +23,13 @@
 
 #include <PointIR/Frame.h>
 #include <PointIR/PointArray.h>
+#include <PointIR/Blob.h>
 
 #include <stdint.h>
 
 #include <memory>
 #include <set>
+#include <vector>
 #include <functional>
 
 
@@ -61,6 +63,14 @@ namespace PointOutput
 	class APointOutput;
 }
 
+namespace Tracker
+{
+	class ATracker;
+	class TrackedPoints;
+}
+
+class Camera;
+
 
 class Processor
 {
@@ -93,6 +103,9 @@ public:
 	bool isCalibrating() const;
 	bool isCalibrationSucceeded() const;
 
+	// The following modules and switches may be changed from any thread - changes take effect with the next frame.
+	// After a module was removed or replaced, it is not used anymore and may be destroyed.
+
 	bool addFrameOutput( FrameOutput::AFrameOutput * output );
 	bool removeFrameOutput( FrameOutput::AFrameOutput * output );
 	void setFrameOutputEnabled( bool enable );
@@ -108,7 +121,45 @@ public:
 	void setPointFilter( PointFilter::APointFilter * pointFilter );
 	PointFilter::APointFilter * getPointFilter() const;
 
-	const PointIR_Frame * getProcessedFrame() const { return (const PointIR_Frame *)(this->frame); }
+	/// The tracker assigns IDs to the filtered points once per frame - the result is passed to all point outputs.
+	void setTracker( Tracker::ATracker * tracker );
+	Tracker::ATracker * getTracker() const;
+	const Tracker::TrackedPoints & getTrackedPoints() const;
+
+	/// Additional cameras are started and stopped with the processor - their points are merged with the ones of the own capture
+	/// after unprojecting, so all cameras share the filter, tracker and outputs. Frame outputs and calibration only use the own capture.
+	bool addCamera( Camera * camera );
+	bool removeCamera( Camera * camera );
+	std::set< Camera * > getCameras();
+	/// Points of different cameras closer than this (in screen units) are merged into one.
+	void setCameraMergeDistance( float distance );
+	float getCameraMergeDistance() const;
+	/// Points of other cameras are only merged if their frame was retrieved at most this many microseconds apart from the processed one.
+	void setCameraSyncWindow( uint64_t microseconds );
+	uint64_t getCameraSyncWindow() const;
+
+	/// Restricts the capture to the calibrated screen area plus the screen margin, if the capture can crop.
+	/// Detected points are still given in coordinates of the whole image, so the calibration stays valid.
+	void setCropToScreen( bool enable );
+	bool isCropToScreen() const;
+	/// Only searches the calibrated screen area plus the screen margin for points. The mask of the screen is only rebuilt
+	/// when the calibration or the region of the capture changes.
+	void setMaskToScreen( bool enable );
+	bool isMaskToScreen() const;
+	/// Margin around the screen for cropping and masking, relative to the image size.
+	void setScreenMargin( float margin );
+	float getScreenMargin() const;
+
+	const PointIR::Frame & getProcessedFrame() const { return this->frame; }
+	/// Number of frames retrieved from the capture so far - identifies the processed frame.
+	uint64_t getFrameNumber() const { return this->frameNumber; }
+	/// Time the processed frame was retrieved from the capture in microseconds of a monotonic clock.
+	uint64_t getFrameTimestamp() const { return this->frameTimestamp; }
+	/// Position of the processed frame in the whole camera image, which may be larger if the capture is cropped.
+	unsigned int getFrameX() const { return this->frameX; }
+	unsigned int getFrameY() const { return this->frameY; }
+	unsigned int getFullFrameWidth() const { return this->fullFrameWidth; }
+	unsigned int getFullFrameHeight() const { return this->fullFrameHeight; }
 
 private:
 	class Impl;
@@ -119,7 +170,14 @@ private:
 	Unprojector::AUnprojector & unprojector;
 
 	PointIR::Frame frame;
+	uint64_t frameNumber = 0;
+	uint64_t frameTimestamp = 0;
+	unsigned int frameX = 0;
+	unsigned int frameY = 0;
+	unsigned int fullFrameWidth = 0;
+	unsigned int fullFrameHeight = 0;
 	PointIR::PointArray pointArray;
+	std::vector< PointIR::Blob > blobs;
 };
 
 
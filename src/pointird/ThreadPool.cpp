@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThreadPool.hpp"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+
+class ThreadPool::Impl
+{
+public:
+	std::vector< std::thread > workers;
+
+	std::mutex mutex;
+	std::condition_variable jobStarted;
+	std::condition_variable jobFinished;
+	bool stop = false;
+	unsigned int generation = 0; // incremented for each job
+	unsigned int busyWorkers = 0;
+
+	// the current job
+	const std::function< void( unsigned int ) > * task = nullptr;
+	unsigned int tasks = 0;
+	std::atomic< unsigned int > nextTask { 0 };
+	std::exception_ptr exception;
+
+	// runs tasks of the current job until none are left
+	void work()
+	{
+		unsigned int index;
+		while( ( index = this->nextTask.fetch_add( 1 ) ) < this->tasks )
+		{
+			try
+			{
+				(*this->task)( index );
+			}
+			catch( ... )
+			{
+				std::lock_guard< std::mutex > lock( this->mutex );
+				if( !this->exception )
+					this->exception = std::current_exception();
+			}
+		}
+	}
+
+	void workerThread()
+	{
+		unsigned int seenGeneration = 0;
+		std::unique_lock< std::mutex > lock( this->mutex );
+		while( true )
+		{
+			this->jobStarted.wait( lock, [&] { return this->stop || this->generation != seenGeneration; } );
+			if( this->stop )
+				return;
+			seenGeneration = this->generation;
+			lock.unlock();
+			this->work();
+			lock.lock();
+			if( !--this->busyWorkers )
+				this->jobFinished.notify_one();
+		}
+	}
+};
+
+
+ThreadPool::ThreadPool( unsigned int threads ) : pImpl( new Impl )
+{
+	if( !threads )
+		threads = std::max( 1u, std::thread::hardware_concurrency() );
+	// the calling thread is one of them
+	for( unsigned int i = 1; i < threads; i++ )
+		this->pImpl->workers.emplace_back( &Impl::workerThread, this->pImpl.get() );
+}
+
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+		this->pImpl->stop = true;
+	}
+	this->pImpl->jobStarted.notify_all();
+	for( std::thread & worker : this->pImpl->workers )
+		worker.join();
+}
+
+
+unsigned int ThreadPool::getThreads() const
+{
+	return this->pImpl->workers.size() + 1;
+}
+
+
+void ThreadPool::run( unsigned int tasks, const std::function< void( unsigned int ) > & task )
+{
+	if( !tasks )
+		return;
+
+	// no need to wake anyone for a single task
+	if( tasks == 1 || this->pImpl->workers.empty() )
+	{
+		for( unsigned int i = 0; i < tasks; i++ )
+			task( i );
+		return;
+	}
+
+	{
+		std::lock_guard< std::mutex > lock( this->pImpl->mutex );
+		this->pImpl->task = &task;
+		this->pImpl->tasks = tasks;
+		this->pImpl->nextTask = 0;
+		this->pImpl->exception = nullptr;
+		this->pImpl->busyWorkers = this->pImpl->workers.size();
+		this->pImpl->generation++;
+	}
+	this->pImpl->jobStarted.notify_all();
+
+	this->pImpl->work();
+
+	std::exception_ptr exception;
+	{
+		std::unique_lock< std::mutex > lock( this->pImpl->mutex );
+		this->pImpl->jobFinished.wait( lock, [this] { return !this->pImpl->busyWorkers; } );
+		this->pImpl->task = nullptr;
+		exception = this->pImpl->exception;
+	}
+	if( exception )
+		std::rethrow_exception( exception );
+}
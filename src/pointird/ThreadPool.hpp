@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _THREADPOOL__INCLUDED_
+#define _THREADPOOL__INCLUDED_
+
+
+#include <memory>
+#include <functional>
+
+
+/**
+ * A fixed set of worker threads which run the tasks of one job at a time.
+ *
+ * The threads are started once and sleep between jobs, so splitting the work of each frame costs no thread creation.
+ */
+class ThreadPool
+{
+public:
+	ThreadPool( const ThreadPool & ) = delete; // disable copy constructor
+	ThreadPool & operator=( const ThreadPool & other ) = delete; // disable assignment operator
+
+	/// Uses the given number of threads including the calling one - 0 for one per hardware thread.
+	ThreadPool( unsigned int threads = 0 );
+	~ThreadPool();
+
+	/// Number of threads working on a job, including the calling one.
+	unsigned int getThreads() const;
+
+	/// Calls task with each index in [0,tasks) on any of the threads and returns when all calls are done.
+	/// The first exception thrown by a task is rethrown after the others finished.
+	void run( unsigned int tasks, const std::function< void( unsigned int ) > & task );
+
+private:
+	class Impl;
+	std::unique_ptr< Impl > pImpl;
+};
+
+
+#endif
@@ -18,6 +18,7 @@
  */
 
 #include "Simple.hpp"
+#include "../PointBatch.hpp"
 
 #include <PointIR/Point.h>
 #include <PointIR/PointArray.h>
@@ -70,6 +71,13 @@ public:
 		assert( x < width && y < height );
 		return elements[ width * y + x ];
 	}
+
+	/// All elements with the given y - contiguous.
+	inline T * row( unsigned int y )
+	{
+		assert( y < height );
+		return elements.data() + width * y;
+	}
 };
 
 
@@ -77,6 +85,8 @@ class Simple::Impl
 {
 public:
 	Matrix< PointIR::Point::Component > distancesCurrentPrevious;
+	PointBatch currentBatch;
+	std::vector< PointIR::Point::Component > bestDistances;
 
 	std::set< int > usedIDs;
 	unsigned int maxID = std::numeric_limits<int>::max();
@@ -135,25 +145,38 @@ void Simple::assignIDs( const PointIR::PointArray & previousPoints, const std::v
                         std::vector<int> & previousToCurrent, std::vector<int> & currentToPrevious )
 {
 	// build distance matrix and mark best matches for each point
-	currentToPrevious.resize( currentPoints.size(), -1 );
+	// one row per previous point, filled from the coordinate columns of all current points at once
+	unsigned int currentCount = currentPoints.size();
+	currentToPrevious.resize( currentCount );
+	std::fill( currentToPrevious.begin(), currentToPrevious.end(), -1 );
 	Matrix< PointIR::Point::Component > & matrix = this->pImpl->distancesCurrentPrevious;
-	matrix.resize( currentPoints.size(), previousPoints.size() );
-	for( unsigned int currentIdx = 0; currentIdx < currentPoints.size(); ++currentIdx )
+	matrix.resize( currentCount, previousPoints.size() );
+	PointBatch & current = this->pImpl->currentBatch;
+	current.assignPositions( currentPoints );
+	const float * currentX = current.x.data();
+	const float * currentY = current.y.data();
+	std::vector< PointIR::Point::Component > & bestDistances = this->pImpl->bestDistances;
+	bestDistances.assign( currentCount, std::numeric_limits< PointIR::Point::Component >::infinity() );
+	for( unsigned int previousIdx = 0; previousIdx < previousPoints.size(); ++previousIdx )
 	{
-		int bestMatchIndex = -1;
-		for( unsigned int previousIdx = 0; previousIdx < previousPoints.size(); ++previousIdx )
+		const PointIR::Point::Component previousX = previousPoints[previousIdx].x;
+		const PointIR::Point::Component previousY = previousPoints[previousIdx].y;
+		PointIR::Point::Component * distances = matrix.row( previousIdx );
+		for( unsigned int currentIdx = 0; currentIdx < currentCount; ++currentIdx )
 		{
-			PointIR::Point::Component distance = currentPoints[currentIdx].squaredDistance( previousPoints[previousIdx] );
-			matrix( currentIdx, previousIdx ) = distance;
-			if( bestMatchIndex >= 0 )
+			PointIR::Point::Component dx = previousX - currentX[currentIdx];
+			PointIR::Point::Component dy = previousY - currentY[currentIdx];
+			distances[currentIdx] = dx * dx + dy * dy;
+		}
+		// the first previous point always matches, later ones only if strictly closer
+		for( unsigned int currentIdx = 0; currentIdx < currentCount; ++currentIdx )
+		{
+			if( !previousIdx || distances[currentIdx] < bestDistances[currentIdx] )
 			{
-				if( distance < matrix( currentIdx, bestMatchIndex ) )
-					bestMatchIndex = previousIdx;
-			} else {
-				bestMatchIndex = previousIdx;
+				bestDistances[currentIdx] = distances[currentIdx];
+				currentToPrevious[currentIdx] = previousIdx;
 			}
 		}
-		currentToPrevious[currentIdx] = bestMatchIndex;
 	}
 
 	// if two points have the same best match, check which one is closer and treat the other one as new
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TrackedPoints.hpp"
+#include "ATracker.hpp"
+
+
+using namespace Tracker;
+
+
+void TrackedPoints::update( ATracker & tracker, const PointIR::PointArray & points, float dt )
+{
+	this->dt = dt;
+	this->frames = 1;
+	this->maxID = tracker.getMaxID();
+
+	// the current frame of the last update becomes the previous one - the buffers are swapped, so nothing is allocated
+	this->previousPoints.swap( this->lastPoints );
+	this->previousIDs.swap( this->currentIDs );
+	this->previousAges.swap( this->currentAges );
+
+	tracker.assignIDs( this->previousPoints, this->previousIDs,
+	                   points, this->currentIDs,
+	                   this->previousToCurrent, this->currentToPrevious );
+	this->lastPoints = points;
+
+	this->currentStates.resize( points.size() );
+	this->currentAges.resize( points.size() );
+	this->currentVelocities.resize( points.size() );
+	for( unsigned int i = 0; i < points.size(); i++ )
+	{
+		int previous = this->currentToPrevious[i];
+		if( previous < 0 || this->currentIDs[i] < 0 )
+		{
+			this->currentStates[i] = DOWN;
+			this->currentAges[i] = 0;
+			this->currentVelocities[i] = PointIR::Point( 0.0f, 0.0f );
+			continue;
+		}
+		this->currentStates[i] = MOVE;
+		this->currentAges[i] = this->previousAges[previous] + 1;
+		if( dt > 0.0f )
+			this->currentVelocities[i] = ( points[i] - this->previousPoints[previous] ) / dt;
+		else
+			this->currentVelocities[i] = PointIR::Point( 0.0f, 0.0f );
+	}
+}
+
+
+
+void TrackedPoints::append( const TrackedPoints & next )
+{
+	this->dt += next.dt;
+	this->frames += next.frames;
+	this->maxID = next.maxID;
+	this->frameNumber = next.frameNumber;
+	this->frameTimestamp = next.frameTimestamp;
+	this->currentIDs = next.currentIDs;
+	this->currentStates = next.currentStates;
+	this->currentAges = next.currentAges;
+	this->currentVelocities = next.currentVelocities;
+	this->previousAges = next.previousAges;
+	this->lastPoints = next.lastPoints;
+
+	// IDs of lifted contacts may have been reused in between - a contact only continues one of the previous points
+	// if it was present in all updates since then
+	this->currentToPrevious.assign( this->currentIDs.size(), -1 );
+	this->previousToCurrent.assign( this->previousIDs.size(), -1 );
+	for( unsigned int i = 0; i < this->currentIDs.size(); i++ )
+	{
+		this->currentStates[i] = DOWN;
+		if( this->currentIDs[i] < 0 || this->currentAges[i] < this->frames )
+			continue;
+		for( unsigned int previous = 0; previous < this->previousIDs.size(); previous++ )
+		{
+			if( this->previousIDs[previous] != this->currentIDs[i] )
+				continue;
+			this->currentToPrevious[i] = previous;
+			this->previousToCurrent[previous] = i;
+			this->currentStates[i] = MOVE;
+			break;
+		}
+	}
+}
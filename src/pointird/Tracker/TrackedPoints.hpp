@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TRACKER_TRACKEDPOINTS__INCLUDED_
+#define _TRACKER_TRACKEDPOINTS__INCLUDED_
+
+
+#include <PointIR/Point.h>
+#include <PointIR/PointArray.h>
+
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace Tracker
+{
+
+class ATracker;
+
+/**
+ * The result of the processor's tracking stage - shared by all point outputs.
+ *
+ * All vectors starting with "current" are indexed like the points passed to the outputs, the "previous" ones
+ * like the points of the last frame. Contacts that disappeared are the previous points without a current index.
+ */
+class TrackedPoints
+{
+public:
+	enum State
+	{
+		DOWN, ///< the contact appeared in this frame
+		MOVE  ///< the contact was already present in the previous frame
+	};
+
+	/// Assigns IDs to the new points and derives their state, age and velocity - dt is the time since the last update in seconds.
+	void update( ATracker & tracker, const PointIR::PointArray & points, float dt );
+
+	/// Replaces the current points by those of a later update, keeping the previous points - for outputs that missed
+	/// the updates in between. Contacts which were lifted meanwhile are still reported, with the previous points.
+	void append( const TrackedPoints & next );
+
+	/// Whether the vectors below describe the current points - false if no tracker is active.
+	bool isValid( const PointIR::PointArray & points ) const { return this->currentIDs.size() == points.size(); }
+
+	std::vector< int > currentIDs;                  ///< -1 if the tracker ran out of IDs
+	std::vector< State > currentStates;
+	std::vector< unsigned int > currentAges;        ///< number of frames the contact has been present before this one
+	std::vector< PointIR::Point > currentVelocities; ///< in units of the point coordinates per second
+	std::vector< int > currentToPrevious;           ///< -1 for new contacts
+
+	PointIR::PointArray previousPoints;
+	std::vector< int > previousIDs;
+	std::vector< int > previousToCurrent;           ///< -1 for contacts that disappeared
+
+	float dt = 0.0f;                                ///< seconds since the previous points
+	unsigned int frames = 1;                        ///< number of updates since the previous points
+
+	uint64_t frameNumber = 0;                       ///< of the frame the current points were detected in - set by the processor
+	uint64_t frameTimestamp = 0;                    ///< like Processor::getFrameTimestamp
+
+	unsigned int getMaxID() const { return this->maxID; }
+
+private:
+	std::vector< unsigned int > previousAges;
+	PointIR::PointArray lastPoints;
+	unsigned int maxID = 0;
+};
+
+}
+
+
+#endif
@@ -24,9 +24,16 @@
 #include <PointIR/Frame.h>
 #include <PointIR/Point.h>
 #include <PointIR/PointArray.h>
+#include <PointIR/Blob.h>
+
+#include "ScreenMask.hpp"
+#include "../PointBatch.hpp"
 
 #include <stdint.h>
 
+#include <cmath>
+#include <algorithm>
+
 #include <vector>
 
 
@@ -49,6 +56,109 @@ public:
 			this->unproject( point );
 	}
 
+	/// Unprojects a batch of points given as separate coordinate columns - override to transform all points in one pass.
+	virtual void unproject( float * x, float * y, size_t count ) const
+	{
+		for( size_t i = 0; i < count; i++ )
+		{
+			PointIR::Point point( x[i], y[i] );
+			this->unproject( point );
+			x[i] = point.x;
+			y[i] = point.y;
+		}
+	}
+	void unproject( PointBatch & batch ) const
+	{
+		this->unproject( batch.x.data(), batch.y.data(), batch.getCount() );
+	}
+
+	/// Unprojects the points and maps the extents of their blobs by unprojecting the rotated half axes of each blob.
+	void unproject( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs ) const
+	{
+		PointBatch batch;
+		this->unproject( pointArray, blobs, batch );
+	}
+
+	/// Same as above - the batch holds the centers and axes of all blobs while they are unprojected in one pass, so passing
+	/// the same batch each frame avoids allocating.
+	void unproject( PointIR::PointArray & pointArray, std::vector< PointIR::Blob > & blobs, PointBatch & batch ) const
+	{
+		const float pi = 3.14159265358979f;
+		size_t count = pointArray.size();
+		batch.resize( 3 * count );
+		float * x = batch.x.data();
+		float * y = batch.y.data();
+		for( size_t i = 0; i < count; i++ )
+		{
+			const PointIR::Point & point = pointArray[i];
+			const PointIR::Blob & blob = blobs[i];
+			float cosAngle = std::cos( blob.angle );
+			float sinAngle = std::sin( blob.angle );
+			x[i] = point.x;
+			y[i] = point.y;
+			x[count+i] = point.x + cosAngle * ( blob.width / 2.0f );
+			y[count+i] = point.y + sinAngle * ( blob.width / 2.0f );
+			x[2*count+i] = point.x - sinAngle * ( blob.height / 2.0f );
+			y[2*count+i] = point.y + cosAngle * ( blob.height / 2.0f );
+		}
+		this->unproject( x, y, 3 * count );
+
+		for( size_t i = 0; i < count; i++ )
+		{
+			PointIR::Point & point = pointArray[i];
+			PointIR::Blob & blob = blobs[i];
+			point = PointIR::Point( x[i], y[i] );
+			PointIR::Point widthAxis = PointIR::Point( x[count+i], y[count+i] ) - point;
+			PointIR::Point heightAxis = PointIR::Point( x[2*count+i], y[2*count+i] ) - point;
+			float width = 2.0f * std::sqrt( widthAxis.x * widthAxis.x + widthAxis.y * widthAxis.y );
+			float height = 2.0f * std::sqrt( heightAxis.x * heightAxis.x + heightAxis.y * heightAxis.y );
+			float boxArea = blob.width * blob.height;
+			if( boxArea > 0.0f )
+				blob.area *= ( width * height ) / boxArea;
+			blob.width = width;
+			blob.height = height;
+			float angle = std::atan2( widthAxis.y, widthAxis.x );
+			if( angle < 0.0f )
+				angle += pi;
+			if( angle >= pi )
+				angle -= pi;
+			blob.angle = angle;
+		}
+	}
+
+	/// Corners of the screen in image pixels - false if unknown, e.g. when not calibrated.
+	virtual bool getScreenCorners( PointIR::Point corners[4] ) const { return false; }
+
+	/// Bounding box of the screen in image pixels.
+	bool getScreenBounds( PointIR::Point & min, PointIR::Point & max ) const
+	{
+		PointIR::Point corners[4];
+		if( !this->getScreenCorners( corners ) )
+			return false;
+		min = max = corners[0];
+		for( int c = 1; c < 4; c++ )
+		{
+			min.x = std::min( min.x, corners[c].x );
+			min.y = std::min( min.y, corners[c].y );
+			max.x = std::max( max.x, corners[c].x );
+			max.y = std::max( max.y, corners[c].y );
+		}
+		return true;
+	}
+
+	/// The pixels covered by the screen in an image of the given size at the given position in the whole camera image.
+	bool getScreenMask( ScreenMask & mask, unsigned int width, unsigned int height,
+	                    unsigned int offsetX = 0, unsigned int offsetY = 0, float margin = 0.0f ) const
+	{
+		PointIR::Point corners[4];
+		if( !this->getScreenCorners( corners ) )
+			return false;
+		mask.build( corners, width, height, offsetX, offsetY, margin );
+		return true;
+	}
+	/// Changes whenever the calibration changes.
+	virtual unsigned int getCalibrationGeneration() const { return 0; }
+
 	virtual std::vector< uint8_t > getRawCalibrationData() const = 0;
 	virtual bool setRawCalibrationData( const std::vector< uint8_t > & data ) = 0;
 };
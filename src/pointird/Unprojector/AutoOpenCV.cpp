@@ -21,6 +21,9 @@
 
 
 #include "AutoOpenCV.hpp"
+#ifdef POINTIR_FIXEDPOINT
+	#include "FixedPointHomography.hpp"
+#endif
 
 #include <PointIR/Frame.h>
 #include <PointIR/Point.h>
@@ -28,6 +31,12 @@
 
 #include <vector>
 #include <iostream>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
 
 #include <opencv2/imgproc/imgproc.hpp>
 #include <opencv2/calib3d/calib3d.hpp>
@@ -52,15 +61,86 @@ static const float mirrorMarkBorder = 0.03f;
 class AutoOpenCV::Impl
 {
 public:
-	unsigned int width = 0;
-	unsigned int height = 0;
+	/// Stored as raw calibration data.
+	struct Calibration
+	{
+		unsigned int width = 0;
+		unsigned int height = 0;
 
-	double perspective[9] =
+		double perspective[9] =
+		{
+			1, 0, 0,
+			0, 1, 0,
+			0, 0, 1
+		};
+	};
+
+	/// The calibration and what is derived from it once per calibration.
+	struct State
 	{
-		1, 0, 0,
-		0, 1, 0,
-		0, 0, 1
+		Calibration calibration;
+#ifdef POINTIR_FIXEDPOINT
+		FixedPointHomography homography;
+#endif
 	};
+
+	// The calibration may be replaced while points are unprojected on another thread. Readers never block - they
+	// retry if the sequence number was odd (write in progress) or changed while copying. The copy itself goes through
+	// atomic words, as a concurrent plain copy would be a data race even if its result is thrown away.
+	static const size_t stateWords = ( sizeof(State) + sizeof(uint64_t) - 1 ) / sizeof(uint64_t);
+	std::atomic< uint64_t > state[ stateWords ];
+	std::atomic< unsigned int > sequence { 0 };
+	std::mutex writeMutex;
+
+	Impl()
+	{
+		static_assert( std::is_trivially_copyable< State >::value, "the state is copied as raw words" );
+		uint64_t words[ stateWords ] = {};
+		State initial;
+		memcpy( words, &initial, sizeof(State) );
+		for( size_t i = 0; i < stateWords; i++ )
+			this->state[i].store( words[i], std::memory_order_relaxed );
+	}
+
+	State readState() const
+	{
+		uint64_t words[ stateWords ];
+		unsigned int before, after;
+		do
+		{
+			before = this->sequence.load( std::memory_order_acquire );
+			for( size_t i = 0; i < stateWords; i++ )
+				words[i] = this->state[i].load( std::memory_order_relaxed );
+			std::atomic_thread_fence( std::memory_order_acquire );
+			after = this->sequence.load( std::memory_order_relaxed );
+		} while( (before & 1) || before != after );
+		State copy;
+		memcpy( &copy, words, sizeof(State) );
+		return copy;
+	}
+
+	Calibration read() const
+	{
+		return this->readState().calibration;
+	}
+
+	void write( const Calibration & calibration )
+	{
+		State state;
+		state.calibration = calibration;
+#ifdef POINTIR_FIXEDPOINT
+		state.homography = FixedPointHomography( calibration.perspective );
+#endif
+		uint64_t words[ stateWords ] = {};
+		memcpy( words, &state, sizeof(State) );
+		std::lock_guard< std::mutex > lock( this->writeMutex );
+		unsigned int current = this->sequence.load( std::memory_order_relaxed );
+		this->sequence.store( current + 1, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );
+		for( size_t i = 0; i < stateWords; i++ )
+			this->state[i].store( words[i], std::memory_order_relaxed );
+		this->sequence.store( current + 2, std::memory_order_release );
+	}
 };
 
 
@@ -136,17 +216,20 @@ AutoOpenCV::~AutoOpenCV()
 
 std::vector< uint8_t > AutoOpenCV::getRawCalibrationData() const
 {
-	std::vector< uint8_t > rawData( sizeof(AutoOpenCV::Impl) );
-	memcpy( rawData.data(), this->pImpl.get(), sizeof(AutoOpenCV::Impl) );
+	Impl::Calibration calibration = this->pImpl->read();
+	std::vector< uint8_t > rawData( sizeof(Impl::Calibration) );
+	memcpy( rawData.data(), &calibration, sizeof(Impl::Calibration) );
 	return rawData;
 }
 
 
 bool AutoOpenCV::setRawCalibrationData( const std::vector< uint8_t > & rawData )
 {
-	if( rawData.size() != sizeof(AutoOpenCV::Impl) )
+	if( rawData.size() != sizeof(Impl::Calibration) )
 		return false;
-	memcpy( this->pImpl.get(), rawData.data(), sizeof(AutoOpenCV::Impl) );
+	Impl::Calibration calibration;
+	memcpy( &calibration, rawData.data(), sizeof(Impl::Calibration) );
+	this->pImpl->write( calibration );
 	return true;
 }
 
@@ -278,9 +361,11 @@ bool AutoOpenCV::calibrate( const PointIR::Frame & frame )
 	};
 	perspective = cv::Mat( 3, 3, CV_64FC1, normalize ) * perspective;
 
-	assert( perspective.total()*perspective.elemSize() == sizeof(AutoOpenCV::Impl::perspective) );
+	Impl::Calibration calibration = this->pImpl->read();
+	assert( perspective.total()*perspective.elemSize() == sizeof(calibration.perspective) );
 	assert( perspective.isContinuous() );
-	memcpy( this->pImpl->perspective, perspective.data, perspective.total()*perspective.elemSize() );
+	memcpy( calibration.perspective, perspective.data, perspective.total()*perspective.elemSize() );
+	this->pImpl->write( calibration );
 	return true;
 }
 
@@ -294,7 +379,8 @@ void AutoOpenCV::unproject( uint8_t * image, unsigned int width, unsigned int he
 		0.0,           (double)height, 0.0,
 		0.0,           0.0,            1.0
 	};
-	cv::Mat perspective = cv::Mat( 3, 3, CV_64FC1, denormalize ) * cv::Mat( 3, 3, CV_64FC1, this->pImpl->perspective );
+	Impl::Calibration calibration = this->pImpl->read();
+	cv::Mat perspective = cv::Mat( 3, 3, CV_64FC1, denormalize ) * cv::Mat( 3, 3, CV_64FC1, calibration.perspective );
 	cv::warpPerspective( img, tmp, perspective, cv::Size( width, height ) );
 	memcpy( image, tmp.data, width * height );
 }
@@ -302,5 +388,56 @@ void AutoOpenCV::unproject( uint8_t * image, unsigned int width, unsigned int he
 
 void AutoOpenCV::unproject( PointIR::Point & point ) const
 {
-	point = unprojected( this->pImpl->perspective, point );
+	this->unproject( &point.x, &point.y, 1 );
+}
+
+
+void AutoOpenCV::unproject( float * x, float * y, size_t count ) const
+{
+#ifdef POINTIR_FIXEDPOINT
+	// the integer matrix is derived when the calibration is set
+	this->pImpl->readState().homography.apply( x, y, count );
+#else
+	// read the calibration once for the whole batch - the loop has no branches or calls and can be vectorized
+	Impl::Calibration calibration = this->pImpl->read();
+	const double * m = calibration.perspective;
+	const double epsilon = std::numeric_limits< double >::epsilon();
+	for( size_t i = 0; i < count; i++ )
+	{
+		double px = x[i];
+		double py = y[i];
+		double w = px * m[6] + py * m[7] + m[8];
+		bool valid = fabs( w ) > epsilon;
+		w = valid ? 1.0 / w : 0.0;
+		x[i] = ( px*m[0] + py*m[1] + m[2] ) * w;
+		y[i] = ( px*m[3] + py*m[4] + m[5] ) * w;
+	}
+#endif
+}
+
+
+bool AutoOpenCV::getScreenCorners( PointIR::Point corners[4] ) const
+{
+	// never calibrated
+	if( !this->pImpl->sequence.load() )
+		return false;
+
+	// project the corners of the normalized screen back into the image
+	Impl::Calibration calibration = this->pImpl->read();
+	cv::Mat perspectiveInv = cv::Mat( 3, 3, CV_64FC1, calibration.perspective ).inv();
+	assert( perspectiveInv.isContinuous() );
+	const PointIR::Point screenCorners[4] = {
+		PointIR::Point( 0.0f, 0.0f ), PointIR::Point( 1.0f, 0.0f ),
+		PointIR::Point( 1.0f, 1.0f ), PointIR::Point( 0.0f, 1.0f )
+	};
+	for( int c = 0; c < 4; c++ )
+		corners[c] = unprojected( (const double *)perspectiveInv.data, screenCorners[c] );
+	return true;
+}
+
+
+unsigned int AutoOpenCV::getCalibrationGeneration() const
+{
+	// each write increments the sequence twice
+	return ( this->pImpl->sequence.load() + 1 ) / 2;
 }
@@ -42,6 +42,11 @@ public:
 
 	virtual void unproject( uint8_t * greyImage, unsigned int width, unsigned int height ) const override;
 	virtual void unproject( PointIR::Point & point ) const override;
+	virtual void unproject( float * x, float * y, size_t count ) const override;
+	using AUnprojector::unproject;
+
+	virtual bool getScreenCorners( PointIR::Point corners[4] ) const override;
+	virtual unsigned int getCalibrationGeneration() const override;
 
 	virtual std::vector< uint8_t > getRawCalibrationData() const override;
 	virtual bool setRawCalibrationData( const std::vector< uint8_t > & data ) override;
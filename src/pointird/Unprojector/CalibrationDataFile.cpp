@@ -29,7 +29,8 @@
 using namespace Unprojector;
 
 
-CalibrationDataFile::CalibrationDataFile( AUnprojector & unprojector, const std::string & directory ) : unprojector(unprojector)
+CalibrationDataFile::CalibrationDataFile( AUnprojector & unprojector, const std::string & directory, const std::string & name ) :
+	unprojector(unprojector)
 {
 	std::stringstream ss;
 	if( !directory.empty() )
@@ -38,7 +39,7 @@ CalibrationDataFile::CalibrationDataFile( AUnprojector & unprojector, const std:
 		if( directory.back() != '/' )
 			ss << '/';
 	}
-	ss << "PointIR.calib";
+	ss << name << ".calib";
 	this->filename = ss.str();
 }
 
@@ -41,7 +41,10 @@ public:
 		: CalibrationDataFile( unprojector, "" ) {}
 #endif
 
-	CalibrationDataFile( AUnprojector & unprojector, const std::string & directory );
+	CalibrationDataFile( AUnprojector & unprojector, const std::string & directory )
+		: CalibrationDataFile( unprojector, directory, "PointIR" ) {}
+	/// The file is named "<name>.calib" - cameras of the same processor need different names.
+	CalibrationDataFile( AUnprojector & unprojector, const std::string & directory, const std::string & name );
 	~CalibrationDataFile();
 
 	std::string getFilename() const { return this->filename; }
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FixedPointHomography.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+using namespace Unprojector;
+
+
+constexpr float FixedPointHomography::maxError;
+
+
+FixedPointHomography::FixedPointHomography()
+{
+	for( int i = 0; i < 9; i++ )
+		this->matrix[i] = ( i % 4 ) ? 0 : ( int64_t(1) << 30 );
+}
+
+
+FixedPointHomography::FixedPointHomography( const double matrix[9] )
+{
+	double largest = 0.0;
+	for( int i = 0; i < 9; i++ )
+		largest = std::max( largest, std::fabs( matrix[i] ) );
+	for( int i = 0; i < 9; i++ )
+		this->matrix[i] = largest > 0.0 ? std::llround( matrix[i] / largest * ( 1 << 30 ) ) : 0;
+}
+
+
+void FixedPointHomography::apply( float * x, float * y, size_t count ) const
+{
+	const int64_t * m = this->matrix;
+	const float limit = 4096.0f;
+	for( size_t i = 0; i < count; i++ )
+	{
+		int64_t px = (int64_t)( std::max( -limit, std::min( limit, x[i] ) ) * 65536.0f );
+		int64_t py = (int64_t)( std::max( -limit, std::min( limit, y[i] ) ) * 65536.0f );
+		// Q46 divided by Q30 gives Q16
+		int64_t w = ( px * m[6] + py * m[7] + m[8] * 65536 ) >> 16;
+		if( !w )
+		{
+			x[i] = y[i] = 0.0f;
+			continue;
+		}
+		x[i] = ( ( px * m[0] + py * m[1] + m[2] * 65536 ) / w ) * ( 1.0f / 65536.0f );
+		y[i] = ( ( px * m[3] + py * m[4] + m[5] * 65536 ) / w ) * ( 1.0f / 65536.0f );
+	}
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _UNPROJECTOR_FIXEDPOINTHOMOGRAPHY__INCLUDED_
+#define _UNPROJECTOR_FIXEDPOINTHOMOGRAPHY__INCLUDED_
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+namespace Unprojector
+{
+
+/// A homography applied with integers only - for targets without a floating point unit.
+/// The matrix is scaled so its largest element is 1 and converted to Q2.30 once, when the homography is set
+/// (the scale cancels in the division). Coordinates are converted to Q16.16 and clamped to +-4096 pixels, so their
+/// products with the matrix stay below 2^60. With the rounding of inputs, matrix and results the unprojected points
+/// are within 2/65536 (of the screen size) of the floating point path.
+class FixedPointHomography
+{
+public:
+	static constexpr float maxError = 2.0f / 65536.0f;
+
+	/// Identity
+	FixedPointHomography();
+	/// The row major 3x3 matrix.
+	FixedPointHomography( const double matrix[9] );
+
+	/// Points with w == 0 become 0,0.
+	void apply( float * x, float * y, size_t count ) const;
+
+private:
+	int64_t matrix[9];
+};
+
+}
+
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ScreenMask.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+
+using namespace Unprojector;
+
+
+void ScreenMask::build( const PointIR::Point corners[4], unsigned int width, unsigned int height,
+                        unsigned int offsetX, unsigned int offsetY, float margin )
+{
+	this->width = width;
+	this->height = height;
+	this->coverage = 0;
+	this->spans.assign( height, Span() );
+
+	for( unsigned int row = 0; row < height; row++ )
+	{
+		// horizontal extent of the quad within the band of the row - for a convex quad it is found at corners
+		// inside the band or where the edges cross the band's borders
+		float top = (float)( row + offsetY ) - margin;
+		float bottom = (float)( row + offsetY + 1 ) + margin;
+		float minX = std::numeric_limits< float >::max();
+		float maxX = std::numeric_limits< float >::lowest();
+		for( int c = 0; c < 4; c++ )
+		{
+			const PointIR::Point & a = corners[c];
+			const PointIR::Point & b = corners[(c+1)%4];
+			if( a.y >= top && a.y <= bottom )
+			{
+				minX = std::min( minX, a.x );
+				maxX = std::max( maxX, a.x );
+			}
+			for( float y : { top, bottom } )
+			{
+				if( ( a.y < y ) == ( b.y < y ) )
+					continue;
+				float x = a.x + ( b.x - a.x ) * ( y - a.y ) / ( b.y - a.y );
+				minX = std::min( minX, x );
+				maxX = std::max( maxX, x );
+			}
+		}
+		if( minX > maxX )
+			continue;
+
+		float start = std::floor( minX - margin ) - (float)offsetX;
+		float end = std::ceil( maxX + margin ) - (float)offsetX;
+		Span & span = this->spans[row];
+		span.start = std::max( 0.0f, std::min( (float)width, start ) );
+		span.end = std::max( (float)span.start, std::min( (float)width, end ) );
+		this->coverage += span.end - span.start;
+	}
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _UNPROJECTOR_SCREENMASK__INCLUDED_
+#define _UNPROJECTOR_SCREENMASK__INCLUDED_
+
+
+#include <PointIR/Point.h>
+
+#include <vector>
+
+
+namespace Unprojector
+{
+
+/// The pixels of an image covered by the screen, given as one [start,end) span per row.
+class ScreenMask
+{
+public:
+	struct Span
+	{
+		unsigned int start = 0;
+		unsigned int end = 0;
+	};
+
+	/// Rasterizes the (convex) screen quad, dilated by margin pixels. The corners are given in pixels of the whole
+	/// camera image, the masked image may be a part of it starting at offsetX,offsetY.
+	void build( const PointIR::Point corners[4], unsigned int width, unsigned int height,
+	            unsigned int offsetX = 0, unsigned int offsetY = 0, float margin = 0.0f );
+
+	unsigned int getWidth() const { return this->width; }
+	unsigned int getHeight() const { return this->height; }
+	/// Number of pixels covered by all spans.
+	unsigned int getCoverage() const { return this->coverage; }
+
+	const Span & operator[]( unsigned int row ) const { return this->spans[row]; }
+
+private:
+	unsigned int width = 0;
+	unsigned int height = 0;
+	unsigned int coverage = 0;
+	std::vector< Span > spans;
+};
+
+}
+
+
+#endif
@@ -19,6 +19,8 @@
 
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <algorithm>
 
 #include <stdlib.h>
 #include <unistd.h>
@@ -34,16 +36,18 @@
 #include <tclap/CmdLine.h>
 
 #include "OutputFactory.hpp"
+#include "TrackerFactory.hpp"
 #include "PointOutput/APointOutput.hpp"
 #include "FrameOutput/AFrameOutput.hpp"
 
 #include "CaptureFactory.hpp"
+#include "DetectorFactory.hpp"
 #include "Capture/ACapture.hpp"
 
 #include "ControllerFactory.hpp"
 #include "Controller/AController.hpp"
 
-#include "PointDetector/OpenCV.hpp"
+#include "PointDetector/APointDetector.hpp"
 
 #include "Unprojector/AutoOpenCV.hpp"
 #include "Unprojector/CalibrationDataFile.hpp"
@@ -54,6 +58,7 @@
 #include "PointFilter/Chain.hpp"
 
 #include "Processor.hpp"
+#include "Camera.hpp"
 
 #include "exceptions.hpp"
 
@@ -131,10 +136,17 @@ private:
 int main( int argc, char ** argv )
 {
 	OutputFactory outputFactory;
+	TrackerFactory trackerFactory;
 	CaptureFactory captureFactory;
+	DetectorFactory detectorFactory;
 	ControllerFactory controllerFactory;
 
 	std::string captureName;
+	std::string detectorName = "cv";
+	std::vector<std::string> cameraDeviceNames;
+	float cameraMergeDistance = 0.02f;
+	bool cropToScreen = false;
+	bool maskToScreen = false;
 	std::vector<std::string> outputNames;
 	std::vector<std::string> controllerNames;
 	CalibrationHook calibrationHook;
@@ -234,6 +246,18 @@ int main( int argc, char ** argv )
 			"The camera device used to capture the video stream.\nDefaults to \"" + captureFactory.deviceName + "\"",
 			false, captureFactory.deviceName, "string", cmd );
 
+		TCLAP::MultiArg<std::string> cameraArg(
+			"", "camera",
+			"Adds another camera device, captured with the same settings on its own thread. The points of all cameras are merged into one screen space.\n"
+			"Each camera needs its own calibration - the one of the N-th additional camera is loaded from \"PointIR.cameraN.calib\" next to \"PointIR.calib\". "
+			"Create it by calibrating the camera as the main device and renaming the saved calibration data.",
+			false, "string", cmd );
+
+		TCLAP::ValueArg<float> cameraMergeDistanceArg(
+			"", "cameraMergeDistance",
+			"Points of different cameras closer than this (relative to the screen size) are taken as the same contact.\nDefaults to " + std::to_string(cameraMergeDistance),
+			false, cameraMergeDistance, "float", cmd );
+
 		TCLAP::ValueArg<int> widthArg(
 			"", "width",
 			"Width of captured video stream. If the device does not support the given resolution, the nearest possible value may be used.\nDefaults to " + std::to_string(captureFactory.width),
@@ -249,6 +273,25 @@ int main( int argc, char ** argv )
 			"Frame rate of captured video stream. If the device does not support the given frame rate, the nearest possible value may be used.\nDefaults to " + std::to_string(captureFactory.fps),
 			false, captureFactory.fps, "float", cmd );
 
+#ifdef POINTIR_V4L2
+		TCLAP::ValueArg<std::string> pixelFormatArg(
+			"", "pixelFormat",
+			"Pixel format (FourCC) requested by the v4l2 capture: GREY, Y16, Y10, YUYV or MJPG. Native greyscale formats need the least bandwidth, MJPEG frames are decoded on a separate thread.\n"
+			"Defaults to the first of these the device supports at the requested size",
+			false, captureFactory.pixelFormat, "string", cmd );
+#endif
+
+		TCLAP::SwitchArg cropToScreenArg(
+			"", "cropToScreen",
+			"Restricts the capture to the calibrated screen area, so less of the image has to be transferred and searched for points. "
+			"The whole image is captured while calibrating.",
+			cmd, cropToScreen );
+
+		TCLAP::SwitchArg maskToScreenArg(
+			"", "maskToScreen",
+			"Only searches the calibrated screen area for points, skipping reflections and other light sources around the screen.",
+			cmd, maskToScreen );
+
 		TCLAP::ValueArg<int> pointLimitArg(
 			"", "pointLimit",
 			"Limit the number of points for the output. 0 to disable.\nDefaults to " + std::to_string(pointLimit),
@@ -259,12 +302,69 @@ int main( int argc, char ** argv )
 			"The luminosity threshold used to detect points in the video capture.\nDefaults to " + std::to_string((unsigned int)detectorIntensityThreshold),
 			false, detectorIntensityThreshold, "int", cmd );
 
-		std::vector< std::string > availableTrackerNames = outputFactory.trackerFactory.getAvailableTrackerNames();
+#ifdef POINTIR_UINPUT
+		TCLAP::ValueArg<int> uinputWidthArg(
+			"", "uinputWidth",
+			"Number of positions on the horizontal axis of the uinput device.\nDefaults to " + std::to_string(outputFactory.uinputWidth),
+			false, outputFactory.uinputWidth, "int", cmd );
+
+		TCLAP::ValueArg<int> uinputHeightArg(
+			"", "uinputHeight",
+			"Number of positions on the vertical axis of the uinput device.\nDefaults to " + std::to_string(outputFactory.uinputHeight),
+			false, outputFactory.uinputHeight, "int", cmd );
+
+		TCLAP::ValueArg<int> uinputResolutionArg(
+			"", "uinputResolution",
+			"Resolution of the uinput device's axes in units per millimeter - lets userspace derive the physical size of the screen. 0 if unknown.\nDefaults to " + std::to_string(outputFactory.uinputResolution),
+			false, outputFactory.uinputResolution, "int", cmd );
+
+		TCLAP::ValueArg<int> uinputFuzzArg(
+			"", "uinputFuzz",
+			"Noise filter applied by the kernel to the uinput device's coordinates, in device units.\nDefaults to " + std::to_string(outputFactory.uinputFuzz),
+			false, outputFactory.uinputFuzz, "int", cmd );
+
+		TCLAP::ValueArg<int> uinputDeadbandArg(
+			"", "uinputDeadband",
+			"Movements of a contact up to this distance in device units are only reported at a limited rate by the uinputB output.\nDefaults to " + std::to_string(outputFactory.uinputDeadband),
+			false, outputFactory.uinputDeadband, "int", cmd );
+
+		TCLAP::ValueArg<float> uinputStationaryIntervalArg(
+			"", "uinputStationaryInterval",
+			"Seconds between the updates the uinputB output sends for a contact moving within the deadband.\nDefaults to " + std::to_string(outputFactory.uinputStationaryInterval),
+			false, outputFactory.uinputStationaryInterval, "float", cmd );
+#endif
+
+#ifdef POINTIR_TUIO
+		TCLAP::MultiArg<std::string> tuioAddressArg(
+			"", "tuioAddress",
+			"Adds a destination for the TUIO output - \"osc.udp://host:port\", \"osc.tcp://host:port\" or \"osc.unix:///path\". Each bundle is encoded once and sent to all destinations.\n"
+			"Defaults to the comma separated list in the POINTIR_TUIO_ADDRESS environment variable or \"osc.udp://127.0.0.1:3333\"",
+			false, "url", cmd );
+
+		TCLAP::SwitchArg tuioBlobsArg(
+			"", "tuioBlobs",
+			"Makes the TUIO output additionally send the /tuio/2Dblb profile with the size, angle and area of each contact.",
+			cmd, outputFactory.tuioBlobs );
+#endif
+
+#ifdef POINTIR_FRAMESTREAM
+		TCLAP::ValueArg<std::string> frameStreamAddressArg(
+			"", "streamAddress",
+			"Address (host:port) the compressed video stream output listens on. Use an empty host to listen on all interfaces.\nDefaults to \"" + outputFactory.frameStreamAddress + "\"",
+			false, outputFactory.frameStreamAddress, "string", cmd );
+
+		TCLAP::ValueArg<int> frameStreamNoiseFloorArg(
+			"", "streamNoiseFloor",
+			"Pixels up to this intensity are sent as black by the compressed video stream output - saves a lot of bandwidth for noisy cameras. 0 keeps the stream lossless.\nDefaults to " + std::to_string(outputFactory.frameStreamNoiseFloor),
+			false, outputFactory.frameStreamNoiseFloor, "int", cmd );
+#endif
+
+		std::vector< std::string > availableTrackerNames = trackerFactory.getAvailableTrackerNames();
 		TCLAP::ValuesConstraint<std::string> trackersArgConstraint( availableTrackerNames );
 		TCLAP::ValueArg<std::string> trackerArg(
 			"", "tracker",
-			"The tracker used for outputs that need identifiiable contact points.\nDefaults to \"" + outputFactory.trackerFactory.getDefaultTrackerName() + "\"",
-			false, outputFactory.trackerFactory.getDefaultTrackerName(), &trackersArgConstraint, cmd );
+			"The tracker assigning IDs to the contact points - shared by all outputs.\nDefaults to \"" + trackerFactory.getDefaultTrackerName() + "\"",
+			false, trackerFactory.getDefaultTrackerName(), &trackersArgConstraint, cmd );
 
 		std::vector< std::string > availableCaptureNames = captureFactory.getAvailableCaptureNames();
 		TCLAP::ValuesConstraint<std::string> capturesArgConstraint( availableCaptureNames );
@@ -273,6 +373,18 @@ int main( int argc, char ** argv )
 			"The capture module used to retrieve the video stream.\nDefaults to \"" + captureName + "\"",
 			false, captureName, &capturesArgConstraint, cmd );
 
+		std::vector< std::string > availableDetectorNames = detectorFactory.getAvailableDetectorNames();
+		TCLAP::ValuesConstraint<std::string> detectorsArgConstraint( availableDetectorNames );
+		TCLAP::ValueArg<std::string> detectorArg(
+			"", "detector",
+			"The point detector searching the frames for bright spots. \"banded\" splits each frame into bands searched on all cores, \"brightest\" only finds the single brightest spot (for setups with one pointer) in a single pass.\nDefaults to \"" + detectorName + "\"",
+			false, detectorName, &detectorsArgConstraint, cmd );
+
+		TCLAP::ValueArg<int> detectorThreadsArg(
+			"", "detectorThreads",
+			"Number of threads used by the banded detector of each camera. 0 for one per core.\nDefaults to " + std::to_string(detectorFactory.threads),
+			false, detectorFactory.threads, "int", cmd );
+
 		std::vector< std::string > availableOutputNames = outputFactory.getAvailableOutputNames();
 		TCLAP::ValuesConstraint<std::string> outputsArgConstraint( availableOutputNames );
 		std::string defaultOutputsAsArgument;
@@ -284,11 +396,16 @@ int main( int argc, char ** argv )
 			"o",  "output",
 			"Adds one or more output modules.\n"
 #ifdef POINTIR_TUIO
-			"For the TUIO protocol you can set the server address with the POINTIR_TUIO_ADDRESS environment variable, e.g. \"osc.udp://127.0.0.1:3331\".\n"
+			"For the TUIO protocol you can set the destinations with --tuioAddress or the POINTIR_TUIO_ADDRESS environment variable, e.g. \"osc.udp://127.0.0.1:3331,osc.tcp://10.0.0.2:3333\".\n"
 #endif
 			"Specifying this will override the default (" + defaultOutputsAsArgument + ")",
 			false, &outputsArgConstraint, cmd );
 
+		TCLAP::MultiArg<std::string> asyncOutputsArg(
+			"",  "async",
+			"Runs the given output on its own worker thread. It only ever gets the newest data, so a slow or stuck output drops frames instead of delaying the processing and the other outputs.",
+			false, &outputsArgConstraint, cmd );
+
 		std::vector< std::string > availableControllerNames = controllerFactory.getAvailableControllerNames();
 		TCLAP::ValuesConstraint<std::string> controllersArgConstraint( availableControllerNames );
 		std::string defaultControllersAsArgument;
@@ -310,14 +427,55 @@ int main( int argc, char ** argv )
 		calibrationHook.setBeginHook( calibrationBeginHookArg.getValue() );
 		calibrationHook.setEndHook( calibrationEndHookArg.getValue() );
 
-		outputFactory.trackerFactory.setDefaultTrackerName( trackerArg.getValue() );
+		trackerFactory.setDefaultTrackerName( trackerArg.getValue() );
+
+#ifdef POINTIR_UINPUT
+		if( uinputWidthArg.getValue() < 2 )
+			throw TCLAP::CmdLineParseException( "needs at least two positions", uinputWidthArg.longID() );
+		if( uinputHeightArg.getValue() < 2 )
+			throw TCLAP::CmdLineParseException( "needs at least two positions", uinputHeightArg.longID() );
+		if( uinputResolutionArg.getValue() < 0 )
+			throw TCLAP::CmdLineParseException( "must not be negative", uinputResolutionArg.longID() );
+		if( uinputFuzzArg.getValue() < 0 )
+			throw TCLAP::CmdLineParseException( "must not be negative", uinputFuzzArg.longID() );
+		if( uinputDeadbandArg.getValue() < 0 )
+			throw TCLAP::CmdLineParseException( "must not be negative", uinputDeadbandArg.longID() );
+		if( !(uinputStationaryIntervalArg.getValue() >= 0.0f) )
+			throw TCLAP::CmdLineParseException( "must not be negative", uinputStationaryIntervalArg.longID() );
+		outputFactory.uinputWidth = uinputWidthArg.getValue();
+		outputFactory.uinputHeight = uinputHeightArg.getValue();
+		outputFactory.uinputResolution = uinputResolutionArg.getValue();
+		outputFactory.uinputFuzz = uinputFuzzArg.getValue();
+		outputFactory.uinputDeadband = uinputDeadbandArg.getValue();
+		outputFactory.uinputStationaryInterval = uinputStationaryIntervalArg.getValue();
+#endif
+
+#ifdef POINTIR_TUIO
+		outputFactory.tuioAddresses = tuioAddressArg.getValue();
+		outputFactory.tuioBlobs = tuioBlobsArg.getValue();
+#endif
+
+#ifdef POINTIR_FRAMESTREAM
+		outputFactory.frameStreamAddress = frameStreamAddressArg.getValue();
+		outputFactory.frameStreamNoiseFloor = std::max( 0, std::min( 255, frameStreamNoiseFloorArg.getValue() ) );
+#endif
 
 		captureName = captureArg.getValue();
+		detectorName = detectorArg.getValue();
+		if( detectorThreadsArg.getValue() >= 0 )
+			detectorFactory.threads = detectorThreadsArg.getValue();
+		cameraDeviceNames = cameraArg.getValue();
+		cameraMergeDistance = cameraMergeDistanceArg.getValue();
+		cropToScreen = cropToScreenArg.getValue();
+		maskToScreen = maskToScreenArg.getValue();
 
 		captureFactory.deviceName = deviceNameArg.getValue();
 		captureFactory.width = widthArg.getValue();
 		captureFactory.height = heigthArg.getValue();
 		captureFactory.fps = fpsArg.getValue();
+#ifdef POINTIR_V4L2
+		captureFactory.pixelFormat = pixelFormatArg.getValue();
+#endif
 
 		if( pointLimitArg.getValue() >= 0 )
 			pointLimit = pointLimitArg.getValue();
@@ -328,6 +486,8 @@ int main( int argc, char ** argv )
 		if( !outputsArg.getValue().empty() )
 			outputNames = outputsArg.getValue();
 
+		outputFactory.asyncOutputNames = asyncOutputsArg.getValue();
+
 		if( !contollersArg.getValue().empty() )
 			controllerNames = contollersArg.getValue();
 	}
@@ -350,14 +510,46 @@ int main( int argc, char ** argv )
 		return 1;
 	}
 
-	PointDetector::OpenCV detector;
-//	detector.setBoundingFilterEnabled( true );
-	detector.setIntensityThreshold( detectorIntensityThreshold );
+	detectorFactory.intensityThreshold = detectorIntensityThreshold;
+	std::unique_ptr< PointDetector::APointDetector > detector( detectorFactory.newDetector( detectorName ) );
+	if( !detector )
+	{
+		std::cerr << "Could not create detector \"" << detectorName << "\"\n";
+		return 1;
+	}
 
 	Unprojector::AutoOpenCV unprojector;
 	Unprojector::CalibrationDataFile calibrationDataFile( unprojector );
 	calibrationDataFile.load();
 
+	// additional cameras with their own modules
+	std::vector< std::unique_ptr< Capture::ACapture > > cameraCaptures;
+	std::vector< std::unique_ptr< PointDetector::APointDetector > > cameraDetectors;
+	std::vector< std::unique_ptr< Unprojector::AutoOpenCV > > cameraUnprojectors;
+	std::vector< std::unique_ptr< Camera > > cameras;
+	for( std::string & cameraDeviceName : cameraDeviceNames )
+	{
+		captureFactory.deviceName = cameraDeviceName;
+		Capture::ACapture * cameraCapture = captureFactory.newCapture( captureName );
+		if( !cameraCapture )
+		{
+			std::cerr << "Could not create capture \"" << captureName << "\" for camera \"" << cameraDeviceName << "\"\n";
+			return 1;
+		}
+		cameraCaptures.emplace_back( cameraCapture );
+
+		cameraDetectors.emplace_back( detectorFactory.newDetector( detectorName ) );
+
+		cameraUnprojectors.emplace_back( new Unprojector::AutoOpenCV );
+		Unprojector::CalibrationDataFile cameraCalibrationDataFile( *cameraUnprojectors.back(),
+			calibrationDataFile.getFilename().substr( 0, calibrationDataFile.getFilename().rfind( '/' ) + 1 ),
+			"PointIR.camera" + std::to_string( cameras.size() + 1 ) );
+		if( !cameraCalibrationDataFile.load() )
+			std::cerr << "Camera \"" << cameraDeviceName << "\" is not calibrated - its points will be off\n";
+
+		cameras.emplace_back( new Camera( *cameraCapture, *cameraDetectors.back(), *cameraUnprojectors.back() ) );
+	}
+
 	PointFilter::Chain pointFilterChain;
 
 	PointFilter::OffscreenFilter offscreenFilter;
@@ -370,9 +562,17 @@ int main( int argc, char ** argv )
 		pointFilterChain.appendFilter( &limitNumberFilter );
 	}
 
-	Processor processor( *capture, detector, unprojector );
+	std::unique_ptr< Tracker::ATracker > tracker( trackerFactory.newTracker() );
+
+	Processor processor( *capture, *detector, unprojector );
 	processor.setPointFilter( &pointFilterChain );
+	processor.setTracker( tracker.get() );
 	processor.addCalibrationListener( &calibrationHook );
+	processor.setCameraMergeDistance( cameraMergeDistance );
+	processor.setCropToScreen( cropToScreen );
+	processor.setMaskToScreen( maskToScreen );
+	for( auto & camera : cameras )
+		processor.addCamera( camera.get() );
 
 	outputFactory.processor = &processor;
 	for( std::string & outputName : outputNames )
@@ -438,6 +638,9 @@ int main( int argc, char ** argv )
 	for( auto controller : controllers )
 		delete controller;
 
+	for( auto camera : processor.getCameras() )
+		processor.removeCamera( camera );
+
 	delete capture;
 
 	for( auto output : processor.getPointOutputs() )
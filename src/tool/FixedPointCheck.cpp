@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2014 Tobias Himmer <provisorisch@online.de>
+ *
+ * This file is part of PointIR.
+ *
+ * PointIR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PointIR is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PointIR.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compares the integer-only unprojection of the POINTIR_FIXEDPOINT build with the floating point one.
+// Runs a fixed set of random calibrations - from an almost affine one up to strong perspective - over the whole
+// camera image and fails if a point is off by more than the documented error.
+
+#include "../pointird/Unprojector/FixedPointHomography.hpp"
+
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+
+static const unsigned int calibrations = 1000;
+static const unsigned int pointsPerCalibration = 256;
+
+
+int main()
+{
+	std::mt19937 random( 1 );
+	std::uniform_real_distribution< double > unit( 0.0, 1.0 );
+
+	double worstError = 0.0;
+	for( unsigned int c = 0; c < calibrations; c++ )
+	{
+		// maps a camera image of width x height pixels to the normalized screen, like a calibration would
+		double width = 320.0 + std::floor( unit( random ) * 1600.0 );
+		double height = 240.0 + std::floor( unit( random ) * 900.0 );
+		double perspective = ( c * 4 ) / calibrations; // 0, 1, 2 or 3
+		double matrix[9] =
+		{
+			( 0.8 + 0.4 * unit( random ) ) / width, 0.05 * ( unit( random ) - 0.5 ) / width, -0.1 * unit( random ),
+			0.05 * ( unit( random ) - 0.5 ) / height, ( 0.8 + 0.4 * unit( random ) ) / height, -0.1 * unit( random ),
+			std::pow( 10.0, perspective - 4.0 ) * ( unit( random ) - 0.5 ) / width,
+			std::pow( 10.0, perspective - 4.0 ) * ( unit( random ) - 0.5 ) / height,
+			1.0
+		};
+		Unprojector::FixedPointHomography homography( matrix );
+
+		float x[ pointsPerCalibration ];
+		float y[ pointsPerCalibration ];
+		double expectedX[ pointsPerCalibration ];
+		double expectedY[ pointsPerCalibration ];
+		for( unsigned int i = 0; i < pointsPerCalibration; i++ )
+		{
+			x[i] = width * unit( random );
+			y[i] = height * unit( random );
+			double w = x[i] * matrix[6] + y[i] * matrix[7] + matrix[8];
+			expectedX[i] = ( x[i] * matrix[0] + y[i] * matrix[1] + matrix[2] ) / w;
+			expectedY[i] = ( x[i] * matrix[3] + y[i] * matrix[4] + matrix[5] ) / w;
+		}
+		homography.apply( x, y, pointsPerCalibration );
+
+		for( unsigned int i = 0; i < pointsPerCalibration; i++ )
+		{
+			// only the part of the camera image that maps near the screen is of interest
+			if( std::fabs( expectedX[i] - 0.5 ) > 1.0 || std::fabs( expectedY[i] - 0.5 ) > 1.0 )
+				continue;
+			double error = std::max( std::fabs( x[i] - expectedX[i] ), std::fabs( y[i] - expectedY[i] ) );
+			worstError = std::max( worstError, error );
+		}
+	}
+
+	std::cout << "largest error: " << worstError << " (allowed " << Unprojector::FixedPointHomography::maxError << ")\n";
+	if( worstError > Unprojector::FixedPointHomography::maxError )
+	{
+		std::cerr << "The fixed point unprojection is less accurate than documented!\n";
+		return 1;
+	}
+	return 0;
+}
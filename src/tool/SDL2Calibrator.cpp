@@ -18,6 +18,7 @@
  */
 
 #include "VideoSocketClient.hpp"
+#include "VideoSharedMemoryClient.hpp"
 #include "DBusClient.hpp"
 #include "lodepng.h"
 
@@ -53,53 +54,73 @@ static const char * notice =
 	"Copyright 2014 Tobias Himmer <provisorisch@online.de>";
 
 
-static SDL_Texture * receiveFrame( const PointIR::VideoSocketClient * video, SDL_Renderer * renderer )
+static SDL_Texture * updateTexture( const uint8_t * pixels, unsigned int width, unsigned int height, size_t stride, SDL_Renderer * renderer )
 {
-	if( !video )
-		return nullptr;
-
 	static SDL_Texture * videoTexture = nullptr;
-	static PointIR::Frame frame;
-
-	if( !video->receiveFrame( frame ) )
-		return videoTexture;
 
-	if( !frame.getWidth() || !frame.getHeight() )
+	if( !pixels || !width || !height )
 		return videoTexture;
 
 	// create or resize texture if needed
 	if( !videoTexture )
 	{
-		videoTexture = SDL_CreateTexture( renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, frame.getWidth(), frame.getHeight() );
+		videoTexture = SDL_CreateTexture( renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, width, height );
 	}
 	else
 	{
 		int textureWidth = 0, textureHeight = 0;
 		SDL_QueryTexture( videoTexture, nullptr, nullptr, &textureWidth, &textureHeight );
-		if( textureWidth != (int)frame.getWidth() || textureHeight != (int)frame.getHeight() )
+		if( textureWidth != (int)width || textureHeight != (int)height )
 		{
 			SDL_DestroyTexture( videoTexture );
-			videoTexture = SDL_CreateTexture( renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, frame.getWidth(), frame.getHeight() );
-			std::cerr << std::string(__PRETTY_FUNCTION__) << ": resized to "<< frame.getWidth() << "x" << frame.getHeight() << "\n";
+			videoTexture = SDL_CreateTexture( renderer, SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, width, height );
+			std::cerr << std::string(__PRETTY_FUNCTION__) << ": resized to "<< width << "x" << height << "\n";
 		}
 	}
 
 	// SDL only supports 3/4 component images !? need to convert here
-	size_t frameSize = frame.size();
-	std::vector< uint8_t > frame3( frameSize * 3 );
-	for( unsigned int i = 0; i < frameSize; i++ )
+	std::vector< uint8_t > frame3( width * height * 3 );
+	uint8_t * out = frame3.data();
+	for( unsigned int y = 0; y < height; y++ )
 	{
-		frame3[i*3] = frame[i];
-		frame3[i*3+1] = frame[i];
-		frame3[i*3+2] = frame[i];
+		const uint8_t * row = pixels + y * stride;
+		for( unsigned int x = 0; x < width; x++ )
+		{
+			*out++ = row[x];
+			*out++ = row[x];
+			*out++ = row[x];
+		}
 	}
 
-	SDL_UpdateTexture( videoTexture, nullptr, frame3.data(), frame.getWidth() * 3 );
+	SDL_UpdateTexture( videoTexture, nullptr, frame3.data(), width * 3 );
 
 	return videoTexture;
 }
 
 
+// prefers frames from shared memory - falls back to the socket if the daemon doesn't publish any
+static SDL_Texture * receiveFrame( const PointIR::VideoSharedMemoryClient * sharedVideo, const PointIR::VideoSocketClient * video, SDL_Renderer * renderer )
+{
+	if( sharedVideo && sharedVideo->isAvailable() )
+	{
+		const PointIR_Frame * shared = sharedVideo->acquireFrame();
+		SDL_Texture * videoTexture = shared ? updateTexture( shared->data, shared->width, shared->height, shared->width, renderer )
+		                                    : updateTexture( nullptr, 0, 0, 0, renderer );
+		sharedVideo->releaseFrame();
+		return videoTexture;
+	}
+
+	if( !video )
+		return nullptr;
+
+	static PointIR::Frame frame;
+	if( !video->receiveFrame( frame ) )
+		return updateTexture( nullptr, 0, 0, 0, renderer );
+
+	return updateTexture( frame.getData(), frame.getWidth(), frame.getHeight(), frame.getStride(), renderer );
+}
+
+
 static SDL_Texture * loadCalibrationImage( const PointIR::DBusClient * dbus, SDL_Renderer * renderer, unsigned int width, unsigned int height )
 {
 	if( !dbus )
@@ -192,12 +213,18 @@ int main( int argc, char ** argv )
 	////////////////////////////////////////////////////////////////
 	// PointIR init
 
+	PointIR::VideoSharedMemoryClient * sharedVideo = nullptr;
 	PointIR::VideoSocketClient * video = nullptr;
 	if( !quick )
 	{
 		try
 		{
+			sharedVideo = new PointIR::VideoSharedMemoryClient;
 			video = new PointIR::VideoSocketClient;
+			// the preview doesn't need every captured frame
+			PointIR_FrameRequest request = {};
+			request.maxFPS = 15;
+			video->setFrameRequest( request );
 		}
 		catch( std::exception & ex )
 		{
@@ -377,9 +404,9 @@ int main( int argc, char ** argv )
 			}
 		}
 
-		if( video )
+		if( sharedVideo || video )
 		{
-			videoTexture = receiveFrame( video, renderer );
+			videoTexture = receiveFrame( sharedVideo, video, renderer );
 			if( videoTexture )
 				SDL_RenderCopy( renderer, videoTexture, nullptr, nullptr );
 		}